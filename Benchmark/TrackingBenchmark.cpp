@@ -0,0 +1,292 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Tracking plugin for the Open Ephys GUI
+    Written by:
+
+    Alessio Buccino     alessiob@ifi.uio.no
+    Mikkel Lepperod
+    Svenn-Arne Dragly
+
+    Center for Integrated Neuroplasticity CINPLA
+    Department of Biosciences
+    University of Oslo
+    Norway
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+    Headless load generator and ingest benchmark for the tracking server.
+
+    Drives a number of OSC tracking sources at a fixed rate (optionally in bursts)
+    against a TrackingServer running in the same process, drains their queues the way
+    the Tracking Port does once per audio block, and reports throughput, losses and
+    the receive-to-dequeue latency distribution.
+
+        tracking_benchmark --sources 8 --rate 500 --burst 4 --duration 10
+*/
+
+#include "TrackingServer.h"
+
+#include "oscpack/osc/OscOutboundPacketStream.h"
+#include "oscpack/ip/UdpSocket.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct BenchmarkOptions
+{
+    int sources = 4;
+    int ports = 1;
+    int basePort = 27020;
+    double rate = 1000.0;       // messages per second and source
+    int burst = 1;              // messages sent back to back per source
+    double duration = 10.0;     // seconds
+    double pollMs = 34.0;       // consumer period (1024 samples at 30 kHz)
+    int capacity = BUFFER_SIZE;
+    overflow_policy policy = drop_oldest;
+    timestamp_mode timestamps = arrival_time;
+};
+
+struct BenchmarkSource
+{
+    std::string address;
+    int port;
+    std::unique_ptr<TrackingQueue> queue;
+    TrackingSourceStats stats;
+};
+
+static void printUsage()
+{
+    std::cout << "usage: tracking_benchmark [options]\n"
+              << "  --sources N      number of tracking sources (4)\n"
+              << "  --ports N        number of UDP ports the sources are spread over (1)\n"
+              << "  --port P         first port (27020)\n"
+              << "  --rate HZ        messages per second per source (1000)\n"
+              << "  --burst K        messages per source sent back to back, at rate/K bursts per second (1)\n"
+              << "  --duration S     seconds to send for (10)\n"
+              << "  --poll MS        consumer period in ms (34)\n"
+              << "  --capacity N     queue capacity per source (" << BUFFER_SIZE << ")\n"
+              << "  --policy P       oldest | newest | latest (oldest)\n"
+              << "  --timestamps T   arrival | kernel (arrival)" << std::endl;
+}
+
+static bool parseOptions (int argc, char* argv[], BenchmarkOptions& options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string name = argv[i];
+        if (i + 1 >= argc)
+            return false;
+        const std::string value = argv[++i];
+
+        if (name == "--sources")
+            options.sources = std::atoi (value.c_str());
+        else if (name == "--ports")
+            options.ports = std::atoi (value.c_str());
+        else if (name == "--port")
+            options.basePort = std::atoi (value.c_str());
+        else if (name == "--rate")
+            options.rate = std::atof (value.c_str());
+        else if (name == "--burst")
+            options.burst = std::atoi (value.c_str());
+        else if (name == "--duration")
+            options.duration = std::atof (value.c_str());
+        else if (name == "--poll")
+            options.pollMs = std::atof (value.c_str());
+        else if (name == "--capacity")
+            options.capacity = std::atoi (value.c_str());
+        else if (name == "--policy" && (value == "oldest" || value == "newest" || value == "latest"))
+            options.policy = value == "oldest" ? drop_oldest : (value == "newest" ? drop_newest : keep_latest);
+        else if (name == "--timestamps" && (value == "arrival" || value == "kernel"))
+            options.timestamps = value == "arrival" ? arrival_time : kernel_time;
+        else
+            return false;
+    }
+
+    return options.sources > 0 && options.ports > 0 && options.rate > 0.0
+           && options.burst > 0 && options.duration > 0.0 && options.pollMs > 0.0
+           && options.capacity > 0;
+}
+
+/** Sleeps until deadline, spinning for the last stretch so bursts go out on time. */
+static void waitUntil (std::chrono::steady_clock::time_point deadline)
+{
+    const auto spin = std::chrono::microseconds (500);
+    const auto now = std::chrono::steady_clock::now();
+
+    if (deadline - now > spin)
+        std::this_thread::sleep_for (deadline - now - spin);
+
+    while (std::chrono::steady_clock::now() < deadline)
+    {
+    }
+}
+
+static double getPercentile (const std::vector<int64_t>& sorted, double percentile)
+{
+    if (sorted.empty())
+        return 0.0;
+
+    const size_t index = std::min (sorted.size() - 1, size_t (percentile / 100.0 * (sorted.size() - 1) + 0.5));
+    return sorted[index] * 1e-6;
+}
+
+int main (int argc, char* argv[])
+{
+    BenchmarkOptions options;
+    if (! parseOptions (argc, argv, options))
+    {
+        printUsage();
+        return 1;
+    }
+
+    TrackingServer server;
+    std::vector<std::unique_ptr<BenchmarkSource>> sources;
+
+    for (int i = 0; i < options.sources; i++)
+    {
+        std::unique_ptr<BenchmarkSource> source (new BenchmarkSource);
+        source->address = "/source" + std::to_string (i);
+        source->port = options.basePort + i % options.ports;
+        source->queue.reset (new TrackingQueue (size_t (options.capacity), options.policy));
+        server.addSource (source->port, source->address, source->queue.get(), &source->stats, options.timestamps);
+        sources.push_back (std::move (source));
+    }
+
+    std::atomic<bool> sending (true);
+    uint64_t sent = 0;
+    uint64_t sendErrors = 0;
+    double sendSeconds = 0.0;
+
+    std::thread sender ([&]
+    {
+        std::vector<std::unique_ptr<UdpTransmitSocket>> sockets;
+        for (int p = 0; p < options.ports; p++)
+            sockets.emplace_back (new UdpTransmitSocket (IpEndpointName ("localhost", options.basePort + p)));
+
+        char buffer[256];
+        const auto interval = std::chrono::duration<double> (options.burst / options.rate);
+        const auto start = std::chrono::steady_clock::now();
+        const auto end = start + std::chrono::duration<double> (options.duration);
+        auto next = start;
+        uint64_t frame = 0;
+
+        while (next < end)
+        {
+            waitUntil (std::chrono::time_point_cast<std::chrono::steady_clock::duration> (next));
+
+            for (int b = 0; b < options.burst; b++, frame++)
+            {
+                for (auto& source : sources)
+                {
+                    osc::OutboundPacketStream packet (buffer, sizeof (buffer));
+                    packet << osc::BeginMessage (source->address.c_str())
+                           << float (frame % 640) << float (frame % 480) << 640.0f << 480.0f
+                           << osc::EndMessage;
+                    try
+                    {
+                        sockets[source->port - options.basePort]->Send (packet.Data(), packet.Size());
+                        sent++;
+                    }
+                    catch (const std::exception&)
+                    {
+                        sendErrors++;
+                    }
+                }
+            }
+
+            next += std::chrono::duration_cast<std::chrono::steady_clock::duration> (interval);
+        }
+
+        sendSeconds = std::chrono::duration<double> (std::chrono::steady_clock::now() - start).count();
+        sending = false;
+    });
+
+    // The consumer stands in for the audio thread: wake once per block and drain every queue.
+    std::vector<int64_t> latencies;
+    latencies.reserve (size_t (options.rate * options.duration * options.sources) + 1);
+    const auto poll = std::chrono::duration_cast<std::chrono::steady_clock::duration> (
+        std::chrono::duration<double, std::milli> (options.pollMs));
+    auto nextPoll = std::chrono::steady_clock::now();
+    int idlePolls = 0;
+
+    // keep draining for a few periods after the sender stops to collect messages in flight
+    while (sending || idlePolls < 5)
+    {
+        nextPoll += poll;
+        std::this_thread::sleep_until (nextPoll);
+
+        const int64_t now = getTrackingClockNs();
+        bool any = false;
+        TrackingData message;
+
+        for (auto& source : sources)
+        {
+            while (source->queue->pop (message))
+            {
+                latencies.push_back (now - message.receiveTimeNs);
+                any = true;
+            }
+        }
+
+        idlePolls = (sending || any) ? 0 : idlePolls + 1;
+    }
+
+    sender.join();
+
+    uint64_t received = 0, drops = 0, parseErrors = 0, wrongArity = 0;
+    size_t highWaterMark = 0;
+
+    for (auto& source : sources)
+    {
+        received += source->stats.getMessageCount();
+        parseErrors += source->stats.getParseErrorCount();
+        wrongArity += source->stats.getWrongArityCount();
+        drops += source->queue->getDropCount();
+        highWaterMark = std::max (highWaterMark, source->queue->getHighWaterMark());
+        server.removeSource (source->queue.get());
+    }
+
+    std::sort (latencies.begin(), latencies.end());
+
+    std::cout << std::fixed << std::setprecision (3)
+              << "sources " << options.sources << " on " << options.ports << " port(s), "
+              << options.rate << " msg/s each, bursts of " << options.burst << "\n"
+              << "sent          " << sent << " in " << sendSeconds << " s ("
+              << sent / sendSeconds << " msg/s), " << sendErrors << " send errors\n"
+              << "received      " << received << " (" << received / sendSeconds << " msg/s), "
+              << (sent > received ? sent - received : 0) << " lost before the server\n"
+              << "dequeued      " << latencies.size() << ", " << drops << " dropped by queues (capacity "
+              << sources.front()->queue->getCapacity() << ", high-water mark " << highWaterMark << ")\n"
+              << "errors        " << parseErrors << " parse, " << wrongArity << " wrong arity\n"
+              << "latency (ms)  receive to dequeue: p50 " << getPercentile (latencies, 50)
+              << "  p95 " << getPercentile (latencies, 95)
+              << "  p99 " << getPercentile (latencies, 99)
+              << "  max " << getPercentile (latencies, 100) << std::endl;
+
+    return 0;
+}
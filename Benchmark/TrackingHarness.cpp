@@ -0,0 +1,379 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Tracking plugin for the Open Ephys GUI
+    Written by:
+
+    Alessio Buccino     alessiob@ifi.uio.no
+    Mikkel Lepperod
+    Svenn-Arne Dragly
+
+    Center for Integrated Neuroplasticity CINPLA
+    Department of Biosciences
+    University of Oslo
+    Norway
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/**
+    Headless harness for the tracking core: feeds a synthetic random walk, or
+    positions recorded to a text file, through each stage of the pipeline in
+    isolation and reports what every stage costs per message.
+
+        tracking_harness --messages 1000000 --circles 8 --mode gauss
+        tracking_harness --input positions.txt
+
+    Input files hold one position per line: "x y" or "x y width height".
+*/
+
+#include "TrackingServer.h"
+#include "TrackingMessageDecoder.h"
+#include "TrackingStimDecision.h"
+#include "TrackingPredictor.h"
+#include "TrackingFilter.h"
+#include "TrackingValidator.h"
+#include "TrackingCalibration.h"
+#include "TrackingKinematics.h"
+#include "TrackingRegionMask.h"
+#include "TrackingPulseScheduler.h"
+
+#include "oscpack/osc/OscOutboundPacketStream.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+static constexpr float pi = 3.14159265358979323846f;
+
+struct HarnessOptions
+{
+    size_t messages = 1000000;
+    int sources = 8;
+    int circles = 4;
+    int port = 27099;
+    stim_mode mode = uniform;
+    std::string input;
+};
+
+static void printUsage()
+{
+    std::cout << "usage: tracking_harness [options]\n"
+              << "  --messages N   synthetic positions to generate (1000000)\n"
+              << "  --input FILE   read positions from FILE instead (\"x y [width height]\" per line)\n"
+              << "  --sources N    OSC addresses registered for dispatch (8)\n"
+              << "  --circles N    stimulation circles (4)\n"
+              << "  --mode M       uniform | gauss | ttl (uniform)\n"
+              << "  --port P       UDP port bound for the full ingest stage (27099)" << std::endl;
+}
+
+static bool parseOptions (int argc, char* argv[], HarnessOptions& options)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string name = argv[i];
+        if (i + 1 >= argc)
+            return false;
+        const std::string value = argv[++i];
+
+        if (name == "--messages")
+            options.messages = size_t (std::atoll (value.c_str()));
+        else if (name == "--input")
+            options.input = value;
+        else if (name == "--sources")
+            options.sources = std::atoi (value.c_str());
+        else if (name == "--circles")
+            options.circles = std::atoi (value.c_str());
+        else if (name == "--port")
+            options.port = std::atoi (value.c_str());
+        else if (name == "--mode" && (value == "uniform" || value == "gauss" || value == "ttl"))
+            options.mode = value == "uniform" ? uniform : (value == "gauss" ? gauss : ttl);
+        else
+            return false;
+    }
+    return options.messages > 0 && options.sources > 0 && options.circles >= 0;
+}
+
+static bool readPositions (const std::string& path, std::vector<TrackingPosition>& positions)
+{
+    std::ifstream file (path);
+    if (! file)
+        return false;
+
+    std::string line;
+    while (std::getline (file, line))
+    {
+        std::istringstream fields (line);
+        TrackingPosition position = { 0.0f, 0.0f, 1.0f, 1.0f };
+        if (fields >> position.x >> position.y)
+        {
+            fields >> position.width >> position.height;
+            positions.push_back (position);
+        }
+    }
+    return ! positions.empty();
+}
+
+/** Random walk in the unit square, the coordinate space of the stimulation circles. */
+static void generatePositions (size_t count, std::vector<TrackingPosition>& positions)
+{
+    std::mt19937 generator (1);
+    std::normal_distribution<float> step (0.0f, 0.005f);
+    float x = 0.5f, y = 0.5f;
+
+    positions.reserve (count);
+    for (size_t i = 0; i < count; i++)
+    {
+        x = std::min (1.0f, std::max (0.0f, x + step (generator)));
+        y = std::min (1.0f, std::max (0.0f, y + step (generator)));
+        positions.push_back ({ x, y, 0.05f, 0.05f });
+    }
+}
+
+/** Runs stage once per message and prints its cost. */
+static void measure (const std::string& name, size_t count, const std::function<void (size_t)>& stage)
+{
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; i++)
+        stage (i);
+    const double seconds = std::chrono::duration<double> (std::chrono::steady_clock::now() - start).count();
+
+    std::cout << std::left << std::setw (22) << name << std::right << std::fixed
+              << std::setprecision (1) << std::setw (10) << seconds * 1e9 / count << " ns/msg"
+              << std::setprecision (2) << std::setw (12) << count / seconds * 1e-6 << " M msg/s" << std::endl;
+}
+
+int main (int argc, char* argv[])
+{
+    HarnessOptions options;
+    if (! parseOptions (argc, argv, options))
+    {
+        printUsage();
+        return 1;
+    }
+
+    std::vector<TrackingPosition> positions;
+    if (options.input.empty())
+        generatePositions (options.messages, positions);
+    else if (! readPositions (options.input, positions))
+    {
+        std::cout << "Could not read positions from " << options.input << std::endl;
+        return 1;
+    }
+    const size_t count = positions.size();
+
+    std::vector<std::string> addresses;
+    for (int s = 0; s < options.sources; s++)
+        addresses.push_back ("/source" + std::to_string (s));
+
+    // every message, encoded the way Bonsai sends it, cycling over the sources
+    std::vector<std::vector<char>> packets (count);
+    char buffer[256];
+    for (size_t i = 0; i < count; i++)
+    {
+        osc::OutboundPacketStream packet (buffer, sizeof (buffer));
+        packet << osc::BeginMessage (addresses[i % addresses.size()].c_str())
+               << positions[i].x << positions[i].y << positions[i].width << positions[i].height
+               << osc::EndMessage;
+        packets[i].assign (packet.Data(), packet.Data() + packet.Size());
+    }
+
+    std::vector<StimCircle> circles;
+    for (int c = 0; c < options.circles; c++)
+    {
+        const float angle = 2.0f * pi * c / options.circles;
+        circles.push_back (StimCircle (0.5f + 0.3f * std::cos (angle), 0.5f + 0.3f * std::sin (angle), 0.1f, true));
+    }
+
+    std::cout << count << " positions, " << options.sources << " sources, "
+              << options.circles << " circles" << std::endl;
+
+    volatile float sink = 0.0f;
+
+    measure ("encode (sender)", count, [&] (size_t i)
+    {
+        osc::OutboundPacketStream packet (buffer, sizeof (buffer));
+        packet << osc::BeginMessage (addresses[i % addresses.size()].c_str())
+               << positions[i].x << positions[i].y << positions[i].width << positions[i].height
+               << osc::EndMessage;
+        sink = sink + float (packet.Size());
+    });
+
+    measure ("decode", count, [&] (size_t i)
+    {
+        const char* address;
+        size_t addressLength;
+        TrackingPosition position;
+        double frameTime;
+        if (decodeTrackingMessage (packets[i].data(), int (packets[i].size()), address, addressLength, position, frameTime))
+            sink = sink + position.x;
+    });
+
+    TrackingDispatchTable<int> routes;
+    for (int s = 0; s < options.sources; s++)
+        routes.add (addresses[s], s);
+
+    measure ("dispatch", count, [&] (size_t i)
+    {
+        const std::string& address = addresses[i % addresses.size()];
+        const std::vector<int>* destinations = routes.find (address.c_str(), address.size());
+        sink = sink + float (destinations != nullptr ? destinations->front() : -1);
+    });
+
+    TrackingQueue queue;
+    measure ("queue push + pop", count, [&] (size_t i)
+    {
+        TrackingData message = { 0, int64_t (i), positions[i] };
+        queue.push (message);
+        queue.pop (message);
+        sink = sink + message.position.y;
+    });
+
+    TrackingSourceStats stats;
+    measure ("stats", count, [&] (size_t i)
+    {
+        stats.recordMessage (int64_t (i) * 8333333);
+    });
+
+    TrackingClockModel clock (1.0e9);
+    measure ("sender clock model", count, [&] (size_t i)
+    {
+        const double frameTime = i / 120.0;
+        clock.addObservation (frameTime, frameTime * 1.0e9 + 2.0e6);
+        sink = sink + float (clock.map (frameTime));
+    });
+
+    TrackingCalibration calibration;
+    const double homography[9] = { 120.0, 10.0, -5.0, -8.0, 100.0, 3.0, 0.05, 0.02, 1.0 };
+    calibration.setModel (homography, -0.2, 0.05, 0.5, 0.5, 100.0, 80.0);
+    measure ("calibration", count, [&] (size_t i)
+    {
+        sink = sink + calibration.apply (positions[i]).x;
+    });
+
+    TrackingValidator validator;
+    validator.setMaxSpeed (5.0);
+    validator.setFillHorizon (0.1);
+    validator.setBounds (true);
+    measure ("validation", count, [&] (size_t i)
+    {
+        tracking_quality quality;
+        sink = sink + validator.validate (i / 30.0, positions[i], quality).x;
+    });
+
+    TrackingFilter smoothing (one_euro_filter);
+    measure ("filter (one-euro)", count, [&] (size_t i)
+    {
+        sink = sink + smoothing.filter (i / 30.0, positions[i]).x;
+    });
+
+    TrackingKinematics kinematics;
+    measure ("kinematics", count, [&] (size_t i)
+    {
+        sink = sink + kinematics.update (i / 30.0, positions[i]).speed;
+    });
+
+    TrackingPredictor predictor (constant_velocity);
+    measure ("prediction", count, [&] (size_t i)
+    {
+        float x, y;
+        predictor.update (i / 30.0, positions[i].x, positions[i].y);
+        if (predictor.predict (i / 30.0 + 0.04, x, y))
+            sink = sink + x;
+    });
+
+    measure ("hit test (linear)", count, [&] (size_t i)
+    {
+        sink = sink + float (TrackingStimDecision::findCircle (circles, positions[i].x, positions[i].y));
+    });
+
+    // the circles followed by a plus maze, as the stimulator orders its regions
+    const StimPolygon maze ({ 0.45f, 0.55f, 0.55f, 0.9f, 0.9f, 0.55f, 0.55f, 0.45f, 0.45f, 0.1f, 0.1f, 0.45f },
+                            { 0.1f, 0.1f, 0.45f, 0.45f, 0.55f, 0.55f, 0.9f, 0.9f, 0.55f, 0.55f, 0.45f, 0.45f }, true);
+    std::vector<const StimArea*> regions;
+    for (const StimCircle& circle : circles)
+        regions.push_back (&circle);
+    regions.push_back (&maze);
+
+    TrackingRegionMask regionMask;
+    regionMask.build (regions);
+    measure ("hit test (mask)", count, [&] (size_t i)
+    {
+        sink = sink + float (regionMask.find (positions[i].x, positions[i].y));
+    });
+
+    TrackingStimDecision decision;
+    TrackingRateTable rates;
+    rates.build (options.mode, 2.0f, 0.5f);
+    std::vector<float> pulseTimes;
+    measure ("stimulation decision", count, [&] (size_t i)
+    {
+        // one position per 1024-sample block at 30 kHz
+        const int regionIn = regionMask.find (positions[i].x, positions[i].y);
+        pulseTimes.clear();
+        sink = sink + float (decision.update (regionIn == -1 ? nullptr : regions[regionIn], options.mode, rates,
+                                              positions[i].x, positions[i].y, 1024.0f / 30000.0f, pulseTimes));
+    });
+
+    // a 5-pulse train per block, drained block by block as the stimulator does
+    TrackingPulseScheduler pulses;
+    pulses.setTrain (60, 210, 5);
+    measure ("pulse scheduling", count, [&] (size_t i)
+    {
+        const int64_t blockStart = int64_t (i) * 1024;
+        pulses.trigger (blockStart + int64_t (positions[i].x * 1024));
+        TrackingPulseEdge edge;
+        while (pulses.nextEdge (blockStart + 1024, edge))
+            sink = sink + float (edge.on);
+    });
+
+    // Everything the receive thread does per datagram: decode, dispatch, stats, queue.
+    try
+    {
+        TrackingPort port (options.port);
+        std::vector<std::unique_ptr<TrackingQueue>> queues;
+        std::vector<std::unique_ptr<TrackingSourceStats>> sourceStats;
+
+        for (int s = 0; s < options.sources; s++)
+        {
+            queues.emplace_back (new TrackingQueue());
+            sourceStats.emplace_back (new TrackingSourceStats());
+            port.addSource (addresses[s], queues.back().get(), sourceStats.back().get(), arrival_time);
+        }
+
+        const IpEndpointName endpoint;
+        TrackingData message;
+        measure ("ingest (TrackingPort)", count, [&] (size_t i)
+        {
+            port.ProcessPacket (packets[i].data(), int (packets[i].size()), endpoint);
+            queues[i % queues.size()]->pop (message);
+        });
+    }
+    catch (const std::runtime_error& e)
+    {
+        std::cout << "Skipping the ingest stage, could not bind port " << options.port << ": " << e.what() << std::endl;
+    }
+
+    return 0;
+}
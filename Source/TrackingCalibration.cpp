@@ -0,0 +1,216 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Tracking plugin for the Open Ephys GUI
+    Written by:
+
+    Alessio Buccino     alessiob@ifi.uio.no
+    Mikkel Lepperod
+    Svenn-Arne Dragly
+
+    Center for Integrated Neuroplasticity CINPLA
+    Department of Biosciences
+    University of Oslo
+    Norway
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TrackingCalibration.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
+TrackingCalibration::TrackingCalibration()
+    : m_k1 (0.0)
+    , m_k2 (0.0)
+    , m_cx (0.5)
+    , m_cy (0.5)
+    , m_scale (1.0)
+    , m_gridSize (0)
+{
+    const double identity[9] = { 1, 0, 0, 0, 1, 0, 0, 0, 1 };
+    std::copy (identity, identity + 9, m_homography);
+}
+
+bool TrackingCalibration::load (const std::string& path, std::string& error)
+{
+    std::ifstream file (path);
+    if (! file)
+    {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    double homography[9];
+    double k1 = 0.0, k2 = 0.0, cx = 0.5, cy = 0.5;
+    double arenaWidth = 0.0, arenaHeight = 0.0;
+    int gridSize = DEF_CALIBRATION_GRID;
+    bool hasHomography = false;
+
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline (file, line))
+    {
+        lineNumber++;
+        line = line.substr (0, line.find ('#'));
+
+        std::istringstream fields (line);
+        std::string keyword;
+        if (! (fields >> keyword))
+            continue;
+
+        bool ok;
+        if (keyword == "distortion")
+        {
+            ok = bool (fields >> k1 >> k2);
+            if (ok && ! (fields >> cx >> cy))
+            {
+                cx = 0.5;
+                cy = 0.5;
+            }
+        }
+        else if (keyword == "homography")
+        {
+            ok = true;
+            for (int i = 0; i < 9 && ok; i++)
+                ok = bool (fields >> homography[i]);
+            hasHomography = ok;
+        }
+        else if (keyword == "arena")
+            ok = (fields >> arenaWidth >> arenaHeight) && arenaWidth > 0.0 && arenaHeight > 0.0;
+        else if (keyword == "grid")
+            ok = (fields >> gridSize) && gridSize >= 1 && gridSize <= 1024;
+        else
+            ok = false;
+
+        if (! ok)
+        {
+            error = path + ":" + std::to_string (lineNumber) + ": cannot read '" + keyword + "'";
+            return false;
+        }
+    }
+
+    if (! hasHomography || arenaWidth <= 0.0)
+    {
+        error = path + ": a calibration needs a homography and an arena size";
+        return false;
+    }
+
+    setModel (homography, k1, k2, cx, cy, arenaWidth, arenaHeight, gridSize);
+    return true;
+}
+
+void TrackingCalibration::setModel (const double homography[9], double k1, double k2, double cx, double cy,
+                                    double arenaWidth, double arenaHeight, int gridSize)
+{
+    std::copy (homography, homography + 9, m_homography);
+    m_k1 = k1;
+    m_k2 = k2;
+    m_cx = cx;
+    m_cy = cy;
+    m_scale = std::max (arenaWidth, arenaHeight);
+    m_gridSize = gridSize;
+    buildGrid();
+}
+
+void TrackingCalibration::clear()
+{
+    m_gridSize = 0;
+    m_gridX.clear();
+    m_gridY.clear();
+}
+
+bool TrackingCalibration::isEnabled() const
+{
+    return m_gridSize > 0;
+}
+
+void TrackingCalibration::undistort (double u, double v, double& x, double& y) const
+{
+    // the lens maps an undistorted point p to c + (p - c)(1 + k1 r^2 + k2 r^4):
+    // invert by fixed point iteration, which converges for any realistic distortion
+    const double du = u - m_cx;
+    const double dv = v - m_cy;
+    double px = du, py = dv;
+    for (int i = 0; i < 20; i++)
+    {
+        const double r2 = px * px + py * py;
+        const double factor = 1.0 + m_k1 * r2 + m_k2 * r2 * r2;
+        px = du / factor;
+        py = dv / factor;
+    }
+    x = m_cx + px;
+    y = m_cy + py;
+}
+
+void TrackingCalibration::imageToWorld (double u, double v, double& x, double& y) const
+{
+    double ux, uy;
+    undistort (u, v, ux, uy);
+
+    const double* h = m_homography;
+    const double w = h[6] * ux + h[7] * uy + h[8];
+    x = (h[0] * ux + h[1] * uy + h[2]) / w / m_scale;
+    y = (h[3] * ux + h[4] * uy + h[5]) / w / m_scale;
+}
+
+void TrackingCalibration::buildGrid()
+{
+    const int nodes = m_gridSize + 1;
+    m_gridX.resize (nodes * nodes);
+    m_gridY.resize (nodes * nodes);
+
+    for (int j = 0; j < nodes; j++)
+    {
+        for (int i = 0; i < nodes; i++)
+        {
+            double x, y;
+            imageToWorld (double (i) / m_gridSize, double (j) / m_gridSize, x, y);
+            m_gridX[j * nodes + i] = float (x);
+            m_gridY[j * nodes + i] = float (y);
+        }
+    }
+}
+
+TrackingPosition TrackingCalibration::apply (const TrackingPosition& position) const
+{
+    if (! isEnabled() || std::isnan (position.x) || std::isnan (position.y))
+        return position;
+
+    const int nodes = m_gridSize + 1;
+    const float gu = position.x * m_gridSize;
+    const float gv = position.y * m_gridSize;
+    const int i = std::min (std::max (int (std::floor (gu)), 0), m_gridSize - 1);
+    const int j = std::min (std::max (int (std::floor (gv)), 0), m_gridSize - 1);
+    const float fu = gu - i;
+    const float fv = gv - j;
+
+    const int k = j * nodes + i;
+    const float w00 = (1.0f - fu) * (1.0f - fv);
+    const float w10 = fu * (1.0f - fv);
+    const float w01 = (1.0f - fu) * fv;
+    const float w11 = fu * fv;
+
+    TrackingPosition calibrated;
+    calibrated.x = w00 * m_gridX[k] + w10 * m_gridX[k + 1] + w01 * m_gridX[k + nodes] + w11 * m_gridX[k + nodes + 1];
+    calibrated.y = w00 * m_gridY[k] + w10 * m_gridY[k + 1] + w01 * m_gridY[k + nodes] + w11 * m_gridY[k + nodes + 1];
+    calibrated.width = float (m_scale);
+    calibrated.height = float (m_scale);
+    return calibrated;
+}
@@ -0,0 +1,104 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Tracking plugin for the Open Ephys GUI
+    Written by:
+
+    Alessio Buccino     alessiob@ifi.uio.no
+    Mikkel Lepperod
+    Svenn-Arne Dragly
+
+    Center for Integrated Neuroplasticity CINPLA
+    Department of Biosciences
+    University of Oslo
+    Norway
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACKINGCALIBRATION_H
+#define TRACKINGCALIBRATION_H
+
+#include "TrackingData.h"
+
+#include <string>
+#include <vector>
+
+#define DEF_CALIBRATION_GRID 64
+
+/**
+    Camera to world calibration: radial lens undistortion followed by a homography
+    onto the arena floor.
+
+    The full model is evaluated once, when the calibration is set, on a regular grid
+    over the image; positions are then mapped by bilinear interpolation in that grid,
+    so every position costs the same whatever the model. Positions outside the image
+    extrapolate from the edge cells.
+
+    Output coordinates are world units divided by the larger arena side, and width
+    and height are both set to that side. Sinks that draw x and y against width and
+    height therefore see the arena undistorted, circles in these coordinates are
+    physically round, and x * width gives world units (e.g. cm).
+
+    Calibration files are plain text, one keyword per line, '#' starts a comment:
+
+        distortion k1 k2 cx cy        radial coefficients, centre in image coordinates (optional)
+        homography h11 h12 ... h33    undistorted image coordinates to world units, row major
+        arena width height            extent of the arena in world units
+        grid n                        cells per side of the lookup grid (optional)
+
+    Image coordinates are the normalised (0 to 1) positions sent by Bonsai.
+*/
+class TrackingCalibration
+{
+public:
+    TrackingCalibration();
+
+    /** Reads and applies a calibration file. On failure the calibration is unchanged and error says why. */
+    bool load (const std::string& path, std::string& error);
+
+    /** Sets the model and rebuilds the lookup grid. */
+    void setModel (const double homography[9], double k1, double k2, double cx, double cy,
+                   double arenaWidth, double arenaHeight, int gridSize = DEF_CALIBRATION_GRID);
+
+    /** Back to passing positions through unchanged. */
+    void clear();
+
+    bool isEnabled() const;
+
+    /** Calibrated position, from the lookup grid. Positions that are not numbers pass through. */
+    TrackingPosition apply (const TrackingPosition& position) const;
+
+    /** Exact model evaluation, as used to build the grid, in output coordinates. */
+    void imageToWorld (double u, double v, double& x, double& y) const;
+
+private:
+    void undistort (double u, double v, double& x, double& y) const;
+    void buildGrid();
+
+    double m_homography[9];
+    double m_k1;
+    double m_k2;
+    double m_cx;
+    double m_cy;
+    double m_scale;
+
+    int m_gridSize;
+    std::vector<float> m_gridX;
+    std::vector<float> m_gridY;
+};
+
+#endif // TRACKINGCALIBRATION_H
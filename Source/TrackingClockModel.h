@@ -0,0 +1,172 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Tracking plugin for the Open Ephys GUI
+    Written by:
+
+    Alessio Buccino     alessiob@ifi.uio.no
+    Mikkel Lepperod
+    Svenn-Arne Dragly
+
+    Center for Integrated Neuroplasticity CINPLA
+    Department of Biosciences
+    University of Oslo
+    Norway
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACKINGCLOCKMODEL_H
+#define TRACKINGCLOCKMODEL_H
+
+#include <cmath>
+
+/**
+    Online linear model (offset plus drift) mapping a remote clock onto a local one.
+
+    Every observation pairs the time at which the sender says a frame was taken with
+    the local time at which it arrived. The drift is an exponentially weighted least
+    squares slope over those pairs, so it follows slow changes in the ratio between
+    the two clocks. Arrivals are only ever late, never early, so the offset tracks the
+    lower envelope of the residuals: it drops immediately to a faster arrival and
+    relaxes upwards only slowly. Network and scheduling latency therefore drop out of
+    mapped times, leaving only the minimum transport delay.
+
+    Times are plain doubles in any unit; nominalRate (local units per remote unit) is
+    used as the slope until enough observations have been seen to estimate it. An
+    observation further than resetThreshold (in remote units) from the model, such as
+    a sender restart or a clock step, starts the fit over.
+*/
+class TrackingClockModel
+{
+public:
+    TrackingClockModel (double nominalRate = 1.0,
+                        double resetThreshold = 10.0,
+                        double forgetting = 0.999,
+                        double offsetRelaxation = 0.001)
+        : m_nominalRate (nominalRate)
+        , m_resetThreshold (resetThreshold)
+        , m_forgetting (forgetting)
+        , m_offsetRelaxation (offsetRelaxation)
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        m_count = 0;
+        m_remoteOrigin = m_localOrigin = 0.0;
+        m_sw = m_sx = m_sy = m_sxx = m_sxy = 0.0;
+        m_slope = m_nominalRate;
+        m_offset = 0.0;
+    }
+
+    void setNominalRate (double nominalRate, double resetThreshold)
+    {
+        if (nominalRate != m_nominalRate || resetThreshold != m_resetThreshold)
+        {
+            m_nominalRate = nominalRate;
+            m_resetThreshold = resetThreshold;
+            reset();
+        }
+    }
+
+    /** Adds one (remote time, local arrival time) pair. */
+    void addObservation (double remoteTime, double localTime)
+    {
+        if (m_count == 0)
+        {
+            m_remoteOrigin = remoteTime;
+            m_localOrigin = localTime;
+        }
+
+        const double x = remoteTime - m_remoteOrigin;
+        const double y = localTime - m_localOrigin;
+
+        if (m_count > 0 && std::abs (y - predict (x)) > m_resetThreshold * m_nominalRate)
+        {
+            reset();
+            addObservation (remoteTime, localTime);
+            return;
+        }
+
+        m_sw = m_forgetting * m_sw + 1.0;
+        m_sx = m_forgetting * m_sx + x;
+        m_sy = m_forgetting * m_sy + y;
+        m_sxx = m_forgetting * m_sxx + x * x;
+        m_sxy = m_forgetting * m_sxy + x * y;
+        m_count++;
+
+        const double denominator = m_sw * m_sxx - m_sx * m_sx;
+        if (m_count >= MIN_OBSERVATIONS && denominator > 0.0)
+        {
+            const double slope = (m_sw * m_sxy - m_sx * m_sy) / denominator;
+            // guard against a degenerate fit (e.g. many frames with the same timestamp)
+            if (slope > 0.5 * m_nominalRate && slope < 2.0 * m_nominalRate)
+                m_slope = slope;
+        }
+
+        const double residual = y - m_slope * x;
+        if (m_count == 1 || residual < m_offset)
+            m_offset = residual;
+        else
+            m_offset += m_offsetRelaxation * (residual - m_offset);
+    }
+
+    /** Local time corresponding to remoteTime. */
+    double map (double remoteTime) const
+    {
+        return m_localOrigin + predict (remoteTime - m_remoteOrigin);
+    }
+
+    /** Remote time corresponding to localTime (the inverse of map()). */
+    double unmap (double localTime) const
+    {
+        return m_remoteOrigin + (localTime - m_localOrigin - m_offset) / m_slope;
+    }
+
+    bool isValid() const
+    {
+        return m_count > 0;
+    }
+
+    double getDrift() const
+    {
+        return m_slope / m_nominalRate;
+    }
+
+private:
+    static constexpr int MIN_OBSERVATIONS = 16;
+
+    double predict (double x) const
+    {
+        return m_offset + m_slope * x;
+    }
+
+    double m_nominalRate;
+    double m_resetThreshold;
+    double m_forgetting;
+    double m_offsetRelaxation;
+
+    long m_count;
+    double m_remoteOrigin;
+    double m_localOrigin;
+    double m_sw, m_sx, m_sy, m_sxx, m_sxy;
+    double m_slope;
+    double m_offset;
+};
+
+#endif // TRACKINGCLOCKMODEL_H
@@ -0,0 +1,60 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Tracking plugin for the Open Ephys GUI
+    Written by:
+
+    Alessio Buccino     alessiob@ifi.uio.no
+    Mikkel Lepperod
+    Svenn-Arne Dragly
+
+    Center for Integrated Neuroplasticity CINPLA
+    Department of Biosciences
+    University of Oslo
+    Norway
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACKINGDATA_H
+#define TRACKINGDATA_H
+
+#include <chrono>
+#include <cstdint>
+
+struct TrackingPosition {
+    float x;
+    float y;
+    float width;
+    float height;
+};
+
+struct TrackingData {
+    // sample number of the event, assigned by TrackingNode when the position is emitted
+    uint64_t timestamp;
+    // best estimate of when the frame was taken, in getTrackingClockNs() time
+    int64_t receiveTimeNs;
+    TrackingPosition position;
+};
+
+/** Software clock shared by the receive thread and the processing thread, in ns. */
+inline int64_t getTrackingClockNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds> (
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#endif // TRACKINGDATA_H
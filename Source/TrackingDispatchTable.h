@@ -0,0 +1,120 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Tracking plugin for the Open Ephys GUI
+    Written by:
+
+    Alessio Buccino     alessiob@ifi.uio.no
+    Mikkel Lepperod
+    Svenn-Arne Dragly
+
+    Center for Integrated Neuroplasticity CINPLA
+    Department of Biosciences
+    University of Oslo
+    Norway
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACKINGDISPATCHTABLE_H
+#define TRACKINGDISPATCHTABLE_H
+
+#include <cstring>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+    Maps OSC address patterns to the destinations registered for them.
+
+    The table is rebuilt on the control path whenever the registered sources change
+    and is read-only on the receive path: each address is interned once as a hash,
+    length and copy of its bytes, so a lookup is a scan over a small contiguous hash
+    array followed by one memcmp, with no allocation. Several addresses can share a
+    table (e.g. red and green LEDs, or several animals, on one port) and one address
+    can fan out to several destinations.
+*/
+template <typename Destination>
+class TrackingDispatchTable
+{
+public:
+    void clear()
+    {
+        m_hashes.clear();
+        m_entries.clear();
+    }
+
+    void add (const std::string& address, const Destination& destination)
+    {
+        const uint32_t hash = hashAddress (address.data(), address.size());
+
+        for (size_t i = 0; i < m_entries.size(); i++)
+        {
+            if (m_hashes[i] == hash && m_entries[i].address == address)
+            {
+                m_entries[i].destinations.push_back (destination);
+                return;
+            }
+        }
+
+        m_hashes.push_back (hash);
+        m_entries.push_back ({ address, { destination } });
+    }
+
+    /** Returns the destinations registered for address, or nullptr if there are none. */
+    const std::vector<Destination>* find (const char* address, size_t length) const
+    {
+        const uint32_t hash = hashAddress (address, length);
+
+        for (size_t i = 0; i < m_hashes.size(); i++)
+        {
+            if (m_hashes[i] == hash
+                && m_entries[i].address.size() == length
+                && std::memcmp (m_entries[i].address.data(), address, length) == 0)
+                return &m_entries[i].destinations;
+        }
+        return nullptr;
+    }
+
+    bool isEmpty() const
+    {
+        return m_entries.empty();
+    }
+
+    /** FNV-1a */
+    static uint32_t hashAddress (const char* address, size_t length)
+    {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < length; i++)
+        {
+            hash ^= uint8_t (address[i]);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+private:
+    struct Entry
+    {
+        std::string address;
+        std::vector<Destination> destinations;
+    };
+
+    std::vector<uint32_t> m_hashes;
+    std::vector<Entry> m_entries;
+};
+
+#endif // TRACKINGDISPATCHTABLE_H
@@ -0,0 +1,160 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Tracking plugin for the Open Ephys GUI
+    Written by:
+
+    Alessio Buccino     alessiob@ifi.uio.no
+    Mikkel Lepperod
+    Svenn-Arne Dragly
+
+    Center for Integrated Neuroplasticity CINPLA
+    Department of Biosciences
+    University of Oslo
+    Norway
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TrackingFilter.h"
+
+#include <algorithm>
+#include <cmath>
+
+// M_PI is not standard C++ and MSVC only defines it on request
+static constexpr double pi = 3.14159265358979323846;
+
+TrackingFilter::TrackingFilter (filter_type type, double cutoff, double beta)
+    : m_type (type)
+    , m_cutoff (cutoff)
+    , m_beta (beta)
+    , m_derivativeCutoff (1.0)
+    , m_isValid (false)
+    , m_lastTime (0.0)
+    , m_count (0)
+{
+}
+
+void TrackingFilter::setType (filter_type type)
+{
+    if (type != m_type)
+    {
+        m_type = type;
+        reset();
+    }
+}
+
+filter_type TrackingFilter::getType() const
+{
+    return m_type;
+}
+
+void TrackingFilter::setCutoff (double cutoff)
+{
+    m_cutoff = cutoff;
+}
+
+void TrackingFilter::setBeta (double beta)
+{
+    m_beta = beta;
+}
+
+void TrackingFilter::reset()
+{
+    m_isValid = false;
+    m_count = 0;
+}
+
+TrackingPosition TrackingFilter::filter (double time, const TrackingPosition& position)
+{
+    if (m_type == no_filter || std::isnan (position.x) || std::isnan (position.y))
+        return position;
+
+    const double dt = time - m_lastTime;
+
+    // messages read from one datagram batch can share a timestamp: with no time in between the
+    // derivative would blow up and open the cutoff, so repeat the last output instead. A clock
+    // that steps backwards is a restart, not a duplicate.
+    if (m_isValid && dt == 0.0 && (m_type == one_euro_filter || m_type == exponential_filter))
+    {
+        TrackingPosition filtered = position;
+        filtered.x = float (m_x.value);
+        filtered.y = float (m_y.value);
+        return filtered;
+    }
+
+    const bool restart = ! m_isValid || dt > 1.0 || dt < 0.0;
+    if (restart)
+    {
+        m_x.value = position.x;
+        m_x.derivative = 0.0;
+        m_y.value = position.y;
+        m_y.derivative = 0.0;
+        m_count = 0;
+    }
+
+    // on a restart the axes already hold the position, so any step leaves them there
+    const double step = restart ? 1.0 : dt;
+
+    TrackingPosition filtered = position;
+    filtered.x = float (filterAxis (m_x, position.x, step));
+    filtered.y = float (filterAxis (m_y, position.y, step));
+
+    m_count++;
+    m_lastTime = time;
+    m_isValid = true;
+    return filtered;
+}
+
+double TrackingFilter::lowPass (double cutoff, double dt) const
+{
+    const double tau = 1.0 / (2.0 * pi * cutoff);
+    return 1.0 / (1.0 + tau / dt);
+}
+
+double TrackingFilter::filterAxis (Axis& axis, double value, double dt)
+{
+    switch (m_type)
+    {
+        case one_euro_filter:
+        {
+            const double derivative = (value - axis.value) / dt;
+            axis.derivative += lowPass (m_derivativeCutoff, dt) * (derivative - axis.derivative);
+            const double cutoff = m_cutoff + m_beta * std::abs (axis.derivative);
+            axis.value += lowPass (cutoff, dt) * (value - axis.value);
+            return axis.value;
+        }
+        case exponential_filter:
+            axis.value += lowPass (m_cutoff, dt) * (value - axis.value);
+            return axis.value;
+
+        case median_filter:
+        {
+            axis.window[m_count % MEDIAN_WINDOW] = float (value);
+            const int n = std::min (m_count + 1, MEDIAN_WINDOW);
+            float sorted[MEDIAN_WINDOW];
+            std::copy (axis.window, axis.window + n, sorted);
+            std::nth_element (sorted, sorted + n / 2, sorted + n);
+            if (n % 2 == 1)
+                return sorted[n / 2];
+            // while the window fills an even count has two middle samples: average them
+            const float lower = *std::max_element (sorted, sorted + n / 2);
+            return 0.5 * (double (lower) + double (sorted[n / 2]));
+        }
+        default:
+            return value;
+    }
+}
@@ -0,0 +1,101 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Tracking plugin for the Open Ephys GUI
+    Written by:
+
+    Alessio Buccino     alessiob@ifi.uio.no
+    Mikkel Lepperod
+    Svenn-Arne Dragly
+
+    Center for Integrated Neuroplasticity CINPLA
+    Department of Biosciences
+    University of Oslo
+    Norway
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACKINGFILTER_H
+#define TRACKINGFILTER_H
+
+#include "TrackingData.h"
+
+#define MEDIAN_WINDOW 3
+
+typedef enum
+{
+  no_filter,
+  one_euro_filter,
+  exponential_filter,
+  median_filter
+} filter_type;
+
+/**
+    Per-source smoothing of tracked positions, one output for every input.
+
+      - one_euro_filter: low-pass whose cutoff rises with speed, so a resting animal
+        is smoothed hard while a running one is followed with little lag
+        (Casiez et al., CHI 2012)
+      - exponential_filter: first order low-pass at the cutoff frequency
+      - median_filter: median of the last MEDIAN_WINDOW positions, removes single
+        frame glitches without smearing edges
+
+    Times are in seconds. Positions that are not numbers (lost tracking) pass through
+    untouched and leave the state alone; a gap longer than a second starts over.
+    State is fixed size and filtering never allocates.
+*/
+class TrackingFilter
+{
+public:
+    TrackingFilter (filter_type type = no_filter, double cutoff = 1.0, double beta = 30.0);
+
+    void setType (filter_type type);
+    filter_type getType() const;
+
+    /** Cutoff in Hz of the exponential filter, and of the one-euro filter at rest. */
+    void setCutoff (double cutoff);
+    /** How fast the one-euro cutoff rises with speed, in Hz per arena width per second. */
+    void setBeta (double beta);
+
+    void reset();
+
+    TrackingPosition filter (double time, const TrackingPosition& position);
+
+private:
+    struct Axis
+    {
+        double value;
+        double derivative;
+        float window[MEDIAN_WINDOW];
+    };
+
+    double lowPass (double cutoff, double dt) const;
+    double filterAxis (Axis& axis, double value, double dt);
+
+    filter_type m_type;
+    double m_cutoff;
+    double m_beta;
+    double m_derivativeCutoff;
+
+    bool m_isValid;
+    double m_lastTime;
+    int m_count;
+    Axis m_x;
+    Axis m_y;
+};
+
+#endif // TRACKINGFILTER_H
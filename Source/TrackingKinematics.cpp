@@ -0,0 +1,123 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Tracking plugin for the Open Ephys GUI
+    Written by:
+
+    Alessio Buccino     alessiob@ifi.uio.no
+    Mikkel Lepperod
+    Svenn-Arne Dragly
+
+    Center for Integrated Neuroplasticity CINPLA
+    Department of Biosciences
+    University of Oslo
+    Norway
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TrackingKinematics.h"
+
+#include <cmath>
+#include <limits>
+
+TrackingKinematics::TrackingKinematics (double window)
+    : m_window (window)
+    , m_head (0)
+    , m_tail (0)
+    , m_count (0)
+    , m_pathLength (0.0f)
+{
+}
+
+void TrackingKinematics::setWindow (double window)
+{
+    m_window = window;
+}
+
+void TrackingKinematics::reset()
+{
+    m_count = 0;
+    m_pathLength = 0.0f;
+}
+
+TrackingMotion TrackingKinematics::update (double time, const TrackingPosition& position)
+{
+    const float nan = std::numeric_limits<float>::quiet_NaN();
+    TrackingMotion motion = { nan, nan, nan, m_pathLength };
+
+    if (std::isnan (position.x) || std::isnan (position.y))
+        return motion;
+
+    if (m_count > 0)
+    {
+        const Sample& last = m_history[(m_head + KINEMATICS_HISTORY - 1) % KINEMATICS_HISTORY];
+        if (time < last.time)
+            return motion;
+        if (time - last.time > 1.0)
+            m_count = 0;
+        else
+            m_pathLength += std::hypot (position.x - last.x, position.y - last.y);
+    }
+
+    if (m_count == 0)
+    {
+        m_head = 0;
+        m_tail = 0;
+    }
+
+    // drop the oldest sample if the history is full, then move the tail up to the
+    // newest sample that is still at least a window old
+    if (m_count == KINEMATICS_HISTORY)
+    {
+        m_tail = (m_tail + 1) % KINEMATICS_HISTORY;
+        m_count--;
+    }
+    while (m_count > 1)
+    {
+        const Sample& next = m_history[(m_tail + 1) % KINEMATICS_HISTORY];
+        if (time - next.time < m_window)
+            break;
+        m_tail = (m_tail + 1) % KINEMATICS_HISTORY;
+        m_count--;
+    }
+
+    Sample& sample = m_history[m_head];
+    sample.time = time;
+    sample.x = position.x;
+    sample.y = position.y;
+    sample.vx = 0.0f;
+    sample.vy = 0.0f;
+
+    motion.pathLength = m_pathLength;
+    if (m_count > 0)
+    {
+        const Sample& old = m_history[m_tail];
+        const float dt = float (time - old.time);
+        if (dt > 0.0f)
+        {
+            sample.vx = (position.x - old.x) / dt;
+            sample.vy = (position.y - old.y) / dt;
+            motion.speed = std::hypot (sample.vx, sample.vy);
+            motion.heading = std::atan2 (sample.vy, sample.vx);
+            motion.acceleration = (motion.speed - std::hypot (old.vx, old.vy)) / dt;
+        }
+    }
+
+    m_head = (m_head + 1) % KINEMATICS_HISTORY;
+    m_count++;
+    return motion;
+}
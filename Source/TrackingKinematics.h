@@ -0,0 +1,88 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Tracking plugin for the Open Ephys GUI
+    Written by:
+
+    Alessio Buccino     alessiob@ifi.uio.no
+    Mikkel Lepperod
+    Svenn-Arne Dragly
+
+    Center for Integrated Neuroplasticity CINPLA
+    Department of Biosciences
+    University of Oslo
+    Norway
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACKINGKINEMATICS_H
+#define TRACKINGKINEMATICS_H
+
+#include "TrackingData.h"
+
+#define KINEMATICS_HISTORY 64
+
+/** Payload of the kinematics events, one per position. */
+struct TrackingMotion {
+    float speed;        // position units per second
+    float heading;      // direction of motion, radians from the x axis towards y
+    float acceleration; // rate of change of speed, position units per second squared
+    float pathLength;   // distance travelled since the last reset, position units
+};
+
+/**
+    Online speed, heading, acceleration and path length of one tracked source.
+
+    Velocity is the displacement over the last window seconds, acceleration the change
+    of that velocity over the same window, so the window trades lag for smoothing.
+    Only the last KINEMATICS_HISTORY positions are kept, which bounds the window at
+    high frame rates, and every update is constant time. Positions that are not numbers
+    produce NaN motion and are otherwise ignored; a gap longer than a second restarts
+    the window but not the path length.
+*/
+class TrackingKinematics
+{
+public:
+    TrackingKinematics (double window = 0.2);
+
+    void setWindow (double window);
+
+    /** Forgets the history and the path length. */
+    void reset();
+
+    /** Adds the position at time (seconds) and returns the motion there. */
+    TrackingMotion update (double time, const TrackingPosition& position);
+
+private:
+    struct Sample
+    {
+        double time;
+        float x;
+        float y;
+        float vx;
+        float vy;
+    };
+
+    double m_window;
+    Sample m_history[KINEMATICS_HISTORY];
+    int m_head;
+    int m_tail;
+    int m_count;
+    float m_pathLength;
+};
+
+#endif // TRACKINGKINEMATICS_H
@@ -29,22 +29,16 @@
     along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
 
-#ifndef TRACKINGDATA_H
-#define TRACKINGDATA_H
+#ifndef TRACKINGMESSAGE_H
+#define TRACKINGMESSAGE_H
 
 #include <ProcessorHeaders.h>
+#include "TrackingData.h"
+#include "TrackingValidator.h"
+#include "TrackingKinematics.h"
 
-struct TrackingPosition {
-    float x;
-    float y;
-    float width;
-    float height;
-};
-
-struct TrackingData {
-    uint64 timestamp;
-    TrackingPosition position;
-};
+#include <unordered_map>
+#include <vector>
 
 struct TrackingSources
 {
@@ -56,6 +50,66 @@ struct TrackingSources
     float height;
     String name;
     String color;
+    TrackingMotion motion;
+};
+
+/**
+    The tracking sources seen by a sink, stored contiguously in the order they were
+    added, with constant time lookup by (node id, event index) for incoming events.
+*/
+class TrackingSourceList
+{
+public:
+    void clear()
+    {
+        m_sources.clear();
+        m_indices.clear();
+    }
+
+    /** Adds a source with no position yet and returns it. */
+    TrackingSources& add (unsigned int sourceId, unsigned int eventIndex)
+    {
+        TrackingSources s;
+        s.eventIndex = eventIndex;
+        s.sourceId = sourceId;
+        s.x_pos = -1;
+        s.y_pos = -1;
+        s.width = -1;
+        s.height = -1;
+        s.name = "Tracking source " + String (eventIndex + 1);
+        s.color = "None";
+        s.motion = TrackingMotion{ 0.0f, 0.0f, 0.0f, 0.0f };
+
+        m_indices[key (sourceId, eventIndex)] = (int) m_sources.size();
+        m_sources.push_back (s);
+        return m_sources.back();
+    }
+
+    /** Routes events from another channel of the same source (e.g. its kinematics) to source index. */
+    void addAlias (unsigned int sourceId, unsigned int eventIndex, int index)
+    {
+        m_indices[key (sourceId, eventIndex)] = index;
+    }
+
+    /** Index of the source, or -1 if it is not in the list. */
+    int indexOf (unsigned int sourceId, unsigned int eventIndex) const
+    {
+        auto it = m_indices.find (key (sourceId, eventIndex));
+        return it != m_indices.end() ? it->second : -1;
+    }
+
+    int size() const { return (int) m_sources.size(); }
+    TrackingSources& operator[] (int i) { return m_sources[i]; }
+    const TrackingSources& operator[] (int i) const { return m_sources[i]; }
+
+private:
+    static uint64 key (unsigned int sourceId, unsigned int eventIndex)
+    {
+        return (uint64 (sourceId) << 32) | eventIndex;
+    }
+
+    std::vector<TrackingSources> m_sources;
+    std::unordered_map<uint64, int> m_indices;
 };
 
-#endif // TRACKINGDATA_H
+#endif // TRACKINGMESSAGE_H
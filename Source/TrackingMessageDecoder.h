@@ -0,0 +1,128 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Tracking plugin for the Open Ephys GUI
+    Written by:
+
+    Alessio Buccino     alessiob@ifi.uio.no
+    Mikkel Lepperod
+    Svenn-Arne Dragly
+
+    Center for Integrated Neuroplasticity CINPLA
+    Department of Biosciences
+    University of Oslo
+    Norway
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACKINGMESSAGEDECODER_H
+#define TRACKINGMESSAGEDECODER_H
+
+#include "TrackingData.h"
+
+#include <cstring>
+#include <cstdint>
+#include <limits>
+
+/** Converts an OSC time tag (NTP 32.32 fixed point) to seconds. */
+inline double timeTagToSeconds (uint64_t timeTag)
+{
+    return double (timeTag >> 32) + double (timeTag & 0xffffffffu) * (1.0 / 4294967296.0);
+}
+
+inline uint32_t readBigEndian32 (const unsigned char* p)
+{
+    return (uint32_t (p[0]) << 24) | (uint32_t (p[1]) << 16)
+         | (uint32_t (p[2]) << 8) | uint32_t (p[3]);
+}
+
+/**
+    Fast path for the fixed tracking message sent by Bonsai: an OSC message with
+    type tags ",ffff" carrying x, y, width and height, optionally followed by the
+    time the frame was taken, either as a double in seconds (",ffffd") or as an
+    OSC time tag (",fffft").
+
+    The packet is validated in one pass (address terminator and padding, type tag
+    string and total size) and the big-endian arguments are byte-swapped straight
+    into position and frameTime. Nothing is allocated and nothing throws: anything
+    that is not exactly one of these messages returns false, and the caller falls
+    back to the full oscpack parser.
+
+    On success address points to the null-terminated address pattern inside data
+    and addressLength holds its length. frameTime is set to the frame time in
+    seconds, or to NaN if the message does not carry one.
+*/
+inline bool decodeTrackingMessage (const char* data, int size,
+                                   const char*& address, size_t& addressLength,
+                                   TrackingPosition& position, double& frameTime)
+{
+    static const char typeTags[6] = { ',', 'f', 'f', 'f', 'f', '\0' };
+    static const size_t typeTagsSize = 8;
+    static const size_t positionSize = 4 * sizeof (uint32_t);
+    static const size_t frameTimeSize = sizeof (uint64_t);
+
+    if (size < 4 || (size & 3) != 0 || data[0] != '/')
+        return false;
+
+    const char* terminator = static_cast<const char*> (std::memchr (data, '\0', size_t (size)));
+    if (terminator == nullptr)
+        return false;
+
+    const size_t length = size_t (terminator - data);
+    const size_t paddedLength = (length + 4) & ~size_t (3);
+
+    if (size_t (size) < paddedLength + typeTagsSize + positionSize
+        || std::memcmp (data + paddedLength, typeTags, 5) != 0)
+        return false;
+
+    // the type tag string is padded to 8 bytes either way: ",ffff\0\0\0" or ",ffffd\0\0"
+    const char* tags = data + paddedLength;
+    const char frameTimeTag = tags[5];
+    const bool hasFrameTime = (frameTimeTag == 'd' || frameTimeTag == 't');
+
+    if ((frameTimeTag != '\0' && ! hasFrameTime) || tags[6] != '\0' || tags[7] != '\0'
+        || size_t (size) != paddedLength + typeTagsSize + positionSize + (hasFrameTime ? frameTimeSize : 0))
+        return false;
+
+    const unsigned char* arguments = reinterpret_cast<const unsigned char*> (tags + typeTagsSize);
+    float* values[4] = { &position.x, &position.y, &position.width, &position.height };
+
+    for (int i = 0; i < 4; i++)
+    {
+        const uint32_t bits = readBigEndian32 (arguments + 4 * i);
+        std::memcpy (values[i], &bits, sizeof (float));
+    }
+
+    frameTime = std::numeric_limits<double>::quiet_NaN();
+
+    if (hasFrameTime)
+    {
+        const unsigned char* p = arguments + positionSize;
+        const uint64_t bits = (uint64_t (readBigEndian32 (p)) << 32) | readBigEndian32 (p + 4);
+
+        if (frameTimeTag == 't')
+            frameTime = timeTagToSeconds (bits);
+        else
+            std::memcpy (&frameTime, &bits, sizeof (double));
+    }
+
+    address = data;
+    addressLength = length;
+    return true;
+}
+
+#endif // TRACKINGMESSAGEDECODER_H
@@ -33,6 +33,8 @@
 #include "TrackingNodeEditor.h"
 #include "TrackingMessage.h"
 
+#include <cmath>
+
 //preallocate memory for msg
 #define BUFFER_MSG_SIZE 256
 
@@ -42,17 +44,76 @@ TrackingNodeSettings::TrackingNodeSettings() :
     m_port(1),
     m_address("27020"),
     m_color("red"),
-    m_messageQueue(new TrackingQueue()),
-    m_server(new TrackingServer(1,"27020"))
+    m_messageQueue(new TrackingQueue(m_queueCapacity, m_overflowPolicy))
+{
+    updateMetadata();
+}
+
+TrackingNodeSettings::~TrackingNodeSettings()
 {
-    m_server->addProcessor(new TrackingNode());
-    m_server->startThread();
+    m_server->removeSource(m_messageQueue);
+    delete m_messageQueue;
+}
+
+void TrackingNodeSettings::connect()
+{
+    m_server->removeSource(m_messageQueue);
+    if (m_port > 0 && m_address.isNotEmpty())
+        m_server->addSource(m_port, m_address.toStdString(), m_messageQueue, &m_stats, m_timestampMode);
+}
+
+void TrackingNodeSettings::updateMetadata()
+{
+    MetadataValueArray metadata;
+    auto desc = MetadataDescriptor{ MetadataDescriptor::MetadataType::CHAR, 15, String("color"), String("Tracking source color to be displayed"), String("channelInfo.extra") };
+    auto color = MetadataValue{ desc };
+    color.setValue(m_color);
+    metadata.add(color);
+    desc = MetadataDescriptor{ MetadataDescriptor::MetadataType::INT32, 1, String("port"), String("Tracking source OSC port"), String("channelInfo.extra") };
+    auto port = MetadataValue{ desc };
+    port.setValue(m_port);
+    metadata.add(port);
+    desc = MetadataDescriptor{ MetadataDescriptor::MetadataType::CHAR, 15, String("address"), String("Tracking source OSC address"), String("channelInfo.extra") };
+    auto address = MetadataValue{ desc };
+    address.setValue(m_address.toLowerCase());
+    metadata.add(address);
+
+    m_metadata.swapWith(metadata);
+}
+
+void TrackingNodeSettings::updateCalibration()
+{
+    if (m_calibrationFile.isEmpty())
+    {
+        m_calibration.clear();
+        return;
+    }
+
+    std::string error;
+    if (m_calibration.load(m_calibrationFile.toStdString(), error))
+        cout << "Tracking Port: loaded calibration " << m_calibrationFile << endl;
+    else
+    {
+        cout << "Tracking Port: calibration not loaded, " << error << endl;
+        CoreServices::sendStatusMessage("Tracking Port: calibration not loaded");
+    }
+}
+
+void TrackingNodeSettings::updateQueue()
+{
+    if (m_messageQueue->getCapacity() == TrackingQueue::getCapacityFor(m_queueCapacity, m_overflowPolicy)
+        && m_messageQueue->getOverflowPolicy() == m_overflowPolicy)
+        return;
+
+    m_server->removeSource(m_messageQueue);
+    delete m_messageQueue;
+    m_messageQueue = new TrackingQueue(m_queueCapacity, m_overflowPolicy);
+    connect();
 }
 
 TrackingNode::TrackingNode() : GenericProcessor ("Tracking Port")
     , m_startingRecTimeMillis (0)
     , m_startingAcqTimeMillis (0)
-    , m_positionIsUpdated (false)
     , m_isRecordingTimeLogged (false)
     , m_isAcquisitionTimeLogged (false)
     , m_received_msg (0)
@@ -68,7 +129,7 @@ TrackingNode::TrackingNode() : GenericProcessor ("Tracking Port")
     addSelectedChannelsParameter(Parameter::GLOBAL_SCOPE, "Port", "Tracking source OSC port", 1);
     addCategoricalParameter(Parameter::GLOBAL_SCOPE,
         "Color",
-        "Tracking source color to be displayed",
+        "Tracking source color to be displayed (auto gives every source its own color)",
         { "red",
         "green",
         "blue",
@@ -78,27 +139,122 @@ TrackingNode::TrackingNode() : GenericProcessor ("Tracking Port")
         "pink",
         "grey",
         "violet",
-        "yellow" },
+        "yellow",
+        "auto" },
         0);
     addIntParameter(Parameter::GLOBAL_SCOPE, "Address", "Tracking source OSC address", 27020, 0, 32768);
+    addCategoricalParameter(Parameter::GLOBAL_SCOPE,
+        "Timestamps",
+        "Stamp positions when the OSC message is parsed (arrival), with the kernel receive time (kernel, Linux only) "
+        "or with the sender's frame time mapped onto the acquisition clock (sender)",
+        { "arrival",
+        "kernel",
+        "sender" },
+        0);
+    addIntParameter(Parameter::GLOBAL_SCOPE, "Queue", "Positions buffered for this source (rounded up to a power of two)", BUFFER_SIZE, 16, 1 << 20);
+    addCategoricalParameter(Parameter::GLOBAL_SCOPE,
+        "Overflow",
+        "What to drop when the queue is full: the oldest position, the newest one, or everything but the latest",
+        { "drop oldest",
+        "drop newest",
+        "latest" },
+        0);
+    addCategoricalParameter(Parameter::GLOBAL_SCOPE,
+        "Filter",
+        "Smoothing of the positions sent on the Tracking data channel; the raw channel always carries them unfiltered",
+        { "off",
+        "one-euro",
+        "exponential",
+        "median" },
+        0);
+    addStringParameter(Parameter::GLOBAL_SCOPE, "Calibration", "Camera to world calibration file (homography, lens distortion, arena size); empty for none", "");
+    addFloatParameter(Parameter::GLOBAL_SCOPE, "Max speed", "Positions further from the last valid one than this speed allows (arena widths per second) are rejected; 0 disables the check", 0.0f, 0.0f, 100.0f, 0.5f);
+    addIntParameter(Parameter::GLOBAL_SCOPE, "Fill", "Rejected or missing positions are extrapolated from the last valid one for up to this many ms", 0, 0, 1000);
+    addCategoricalParameter(Parameter::GLOBAL_SCOPE,
+        "Bounds",
+        "Reject positions outside the normalised arena",
+        { "off",
+        "0-1" },
+        0);
+    addFloatParameter(Parameter::GLOBAL_SCOPE, "Cutoff", "Cutoff frequency (Hz) of the exponential filter, and of the one-euro filter at rest", 1.0f, 0.1f, 30.0f, 0.1f);
+    addIntParameter(Parameter::GLOBAL_SCOPE, "Window", "Time (ms) over which speed, heading and acceleration are measured", 200, 10, 2000);
     lastNumInputs = 0;
 }
 
 AudioProcessorEditor* TrackingNode::createEditor()
 {
-    auto editor = std::make_unique<AudioProcessorEditor>(this, true);
+    editor = std::make_unique<TrackingNodeEditor>(this);
     return editor.get();
 }
 
+// the audio thread hands m_metadata to every data event while acquiring: rebuild it once acquisition stops
+static void updateMetadataWhenIdle(TrackingNodeSettings* module)
+{
+    if (CoreServices::getAcquisitionStatus())
+        cout << "Tracking Port: event metadata changes take effect when acquisition stops" << endl;
+    else
+        module->updateMetadata();
+}
+
 void TrackingNode::parameterValueChanged(Parameter* param) {
     if (param->getName().equalsIgnoreCase("Address")) {
         settings[param->getStreamId()]->m_address = (String)param->getValue();
+        updateMetadataWhenIdle(settings[param->getStreamId()]);
+        settings[param->getStreamId()]->connect();
     }
     else if (param->getName().equalsIgnoreCase("Port")) {
         settings[param->getStreamId()]->m_port = (int)param->getValue();
+        updateMetadataWhenIdle(settings[param->getStreamId()]);
+        settings[param->getStreamId()]->connect();
     }
     else if (param->getName().equalsIgnoreCase("color")) {
         settings[param->getStreamId()]->m_color = (String)param->getValue();
+        updateMetadataWhenIdle(settings[param->getStreamId()]);
+    }
+    else if (param->getName().equalsIgnoreCase("Timestamps")) {
+        settings[param->getStreamId()]->m_timestampMode = (timestamp_mode)(int)param->getValue();
+        settings[param->getStreamId()]->connect();
+    }
+    else if (param->getName().equalsIgnoreCase("Calibration")) {
+        auto* module = settings[param->getStreamId()];
+        module->m_calibrationFile = (String)param->getValue();
+
+        // the audio thread reads the lookup grid while acquiring
+        if (CoreServices::getAcquisitionStatus())
+            cout << "Tracking Port: calibration changes take effect when acquisition stops" << endl;
+        else
+            module->updateCalibration();
+    }
+    else if (param->getName().equalsIgnoreCase("Max speed")) {
+        settings[param->getStreamId()]->m_validator.setMaxSpeed((float)param->getValue());
+    }
+    else if (param->getName().equalsIgnoreCase("Fill")) {
+        settings[param->getStreamId()]->m_validator.setFillHorizon((int)param->getValue() / 1000.0);
+    }
+    else if (param->getName().equalsIgnoreCase("Bounds")) {
+        settings[param->getStreamId()]->m_validator.setBounds((int)param->getValue() == 1);
+    }
+    else if (param->getName().equalsIgnoreCase("Filter")) {
+        settings[param->getStreamId()]->m_filter.setType((filter_type)(int)param->getValue());
+    }
+    else if (param->getName().equalsIgnoreCase("Cutoff")) {
+        settings[param->getStreamId()]->m_filter.setCutoff((float)param->getValue());
+    }
+    else if (param->getName().equalsIgnoreCase("Window")) {
+        settings[param->getStreamId()]->m_kinematics.setWindow((int)param->getValue() / 1000.0);
+    }
+    else if (param->getName().equalsIgnoreCase("Queue") || param->getName().equalsIgnoreCase("Overflow")) {
+        auto* module = settings[param->getStreamId()];
+        if (param->getName().equalsIgnoreCase("Queue"))
+            module->m_queueCapacity = (int)param->getValue();
+        else
+            module->m_overflowPolicy = (overflow_policy)(int)param->getValue();
+
+        // the audio thread reads the queue while acquiring: swap it once acquisition stops
+        if (CoreServices::getAcquisitionStatus())
+            cout << "Tracking Port: queue changes take effect when acquisition stops" << endl;
+        else
+            module->updateQueue();
     }
 }
 
@@ -114,17 +270,60 @@ void TrackingNode::updateSettings()
         parameterValueChanged(stream->getParameter("Address"));
         parameterValueChanged(stream->getParameter("Color"));
         parameterValueChanged(stream->getParameter("Port"));
+        parameterValueChanged(stream->getParameter("Timestamps"));
+        parameterValueChanged(stream->getParameter("Queue"));
+        parameterValueChanged(stream->getParameter("Overflow"));
+        parameterValueChanged(stream->getParameter("Calibration"));
+        parameterValueChanged(stream->getParameter("Max speed"));
+        parameterValueChanged(stream->getParameter("Fill"));
+        parameterValueChanged(stream->getParameter("Bounds"));
+        parameterValueChanged(stream->getParameter("Filter"));
+        parameterValueChanged(stream->getParameter("Cutoff"));
+        parameterValueChanged(stream->getParameter("Window"));
 
         EventChannel::Settings s{ EventChannel::Type::CUSTOM,
             "Tracking data",
-            "Tracking data received from Bonsai. x, y, width, height",
-            "external.tracking.rawData",
+            "Tracking data received from Bonsai, after calibration, validation and the selected filter. x, y, width, height",
+            "external.tracking.filteredData",
             getDataStream(stream->getStreamId())
         };
 
         eventChannels.add(new EventChannel(s));
         eventChannels.getLast()->addProcessor(processorInfo.get());
         settings[stream->getStreamId()]->eventChannel = eventChannels.getLast();
+
+        EventChannel::Settings raw{ EventChannel::Type::CUSTOM,
+            "Tracking data raw",
+            "Tracking data received from Bonsai, unfiltered. x, y, width, height",
+            "external.tracking.rawData",
+            getDataStream(stream->getStreamId())
+        };
+
+        eventChannels.add(new EventChannel(raw));
+        eventChannels.getLast()->addProcessor(processorInfo.get());
+        settings[stream->getStreamId()]->rawEventChannel = eventChannels.getLast();
+
+        EventChannel::Settings quality{ EventChannel::Type::CUSTOM,
+            "Tracking quality",
+            "Validation of every tracking position: 0 valid, 1 filled, 2 missing, 3 out of bounds, 4 too fast",
+            "external.tracking.quality",
+            getDataStream(stream->getStreamId())
+        };
+
+        eventChannels.add(new EventChannel(quality));
+        eventChannels.getLast()->addProcessor(processorInfo.get());
+        settings[stream->getStreamId()]->qualityEventChannel = eventChannels.getLast();
+
+        EventChannel::Settings kinematics{ EventChannel::Type::CUSTOM,
+            "Tracking kinematics",
+            "Motion at every tracking position. speed, heading (rad), acceleration, path length",
+            "external.tracking.kinematics",
+            getDataStream(stream->getStreamId())
+        };
+
+        eventChannels.add(new EventChannel(kinematics));
+        eventChannels.getLast()->addProcessor(processorInfo.get());
+        settings[stream->getStreamId()]->kinematicsEventChannel = eventChannels.getLast();
     }
     lastNumInputs = getNumInputs();
 }
@@ -286,59 +485,105 @@ void TrackingNode::process (AudioSampleBuffer&)
 {
     checkForEvents();
 
-    if (!m_positionIsUpdated)
-    {
-        return;
-    }
-
-    lock.enter();
+    const int64 callbackTimeNs = getTrackingClockNs();
 
     for (auto stream : getDataStreams()) {
         if ((*stream)["enable_stream"])
         {
             auto * module = settings[stream->getStreamId()];
-            while (true) {
-                auto* message = module->m_messageQueue->pop();
-                if (!message) {
-                    break;
-                }
-
-                const uint16 streamId = stream->getStreamId();
-                const int64 firstSampleInBlock = getFirstSampleNumberForBlock(streamId);
-                const uint32 numSamplesInBlock = getNumSamplesInBlock(streamId);
-
-                setTimestampAndSamples(firstSampleInBlock,
-                    uint64(message->timestamp),
-                    numSamplesInBlock,
-                    streamId);
-                MetadataValueArray metadata;
-                auto desc = MetadataDescriptor{ MetadataDescriptor::MetadataType::CHAR, 15, String("color"), String("Tracking source color to be displayed"), String("channelInfo.extra") };
-                auto color = MetadataValue{ desc };
-                color.setValue(module->m_color);
-                metadata.add(color);
-                desc = MetadataDescriptor{ MetadataDescriptor::MetadataType::INT32, 1, String("port"), String("Tracking source OSC port"), String("channelInfo.extra") };
-                auto port = MetadataValue{ desc };
-                port.setValue(module->m_port);
-                metadata.add(port);
-                desc = MetadataDescriptor{ MetadataDescriptor::MetadataType::CHAR, 15, String("address"), String("Tracking source OSC address"), String("channelInfo.extra") };
-                auto address = MetadataValue{ desc };
-                address.setValue(module->m_address.toLowerCase());
-                metadata.add(address);
-
-                const EventChannel* chan = settings[stream->getStreamId()]->eventChannel;
-                BinaryEventPtr event = BinaryEvent::createBinaryEvent(chan,
-                    message->timestamp,
-                    reinterpret_cast<uint8_t*>(&(message->position)),
+
+            const uint16 streamId = stream->getStreamId();
+            const int64 firstSampleInBlock = getFirstSampleNumberForBlock(streamId);
+            const uint32 numSamplesInBlock = getNumSamplesInBlock(streamId);
+
+            updateSampleClock(module, stream->getSampleRate(), firstSampleInBlock + numSamplesInBlock, callbackTimeNs);
+
+            if (module->m_messageQueue->isEmpty() || numSamplesInBlock == 0)
+                continue;
+
+            // the block keeps its own start; each event carries its sample offset within it
+            setTimestampAndSamples(firstSampleInBlock,
+                getFirstTimestampForBlock(streamId),
+                numSamplesInBlock,
+                streamId);
+
+            TrackingData message;
+            while (module->m_messageQueue->pop(message)) {
+                const int sampleOffset = getSampleOffset(module, message.receiveTimeNs, firstSampleInBlock, numSamplesInBlock);
+                message.timestamp = uint64(firstSampleInBlock + sampleOffset);
+
+                BinaryEventPtr rawEvent = BinaryEvent::createBinaryEvent(module->rawEventChannel,
+                    message.timestamp,
+                    reinterpret_cast<uint8_t*>(&(message.position)),
+                    sizeof(TrackingPosition),
+                    MetadataValueArray());
+                addEvent(rawEvent, sampleOffset);
+
+                const double time = double(message.receiveTimeNs) * 1.0e-9;
+                tracking_quality quality;
+                // validate the raw position, so the lost-tracking marker (0, 0) is seen before calibration moves it
+                TrackingPosition position = module->m_validator.validate(time, message.position, quality);
+                position = module->m_calibration.apply(position);
+                position = module->m_filter.filter(time, position);
+
+                uint8 qualityFlag = uint8(quality);
+                BinaryEventPtr qualityEvent = BinaryEvent::createBinaryEvent(module->qualityEventChannel,
+                    message.timestamp,
+                    &qualityFlag,
+                    sizeof(uint8),
+                    MetadataValueArray());
+                addEvent(qualityEvent, sampleOffset);
+
+                // the source metadata travels once per position, on the data event
+                BinaryEventPtr event = BinaryEvent::createBinaryEvent(module->eventChannel,
+                    message.timestamp,
+                    reinterpret_cast<uint8_t*>(&position),
                     sizeof(TrackingPosition),
-                    metadata);
-                addEvent(event, firstSampleInBlock);
+                    module->m_metadata);
+                addEvent(event, sampleOffset);
+
+                TrackingMotion motion = module->m_kinematics.update(time, position);
+                BinaryEventPtr kinematicsEvent = BinaryEvent::createBinaryEvent(module->kinematicsEventChannel,
+                    message.timestamp,
+                    reinterpret_cast<uint8_t*>(&motion),
+                    sizeof(TrackingMotion),
+                    MetadataValueArray());
+                addEvent(kinematicsEvent, sampleOffset);
             }
         }
     }
+}
+
+void TrackingNode::updateSampleClock (TrackingNodeSettings* module, float sampleRate,
+                                      int64 blockEndSample, int64 callbackTimeNs)
+{
+    // The last sample of a block has been acquired by the time its callback runs, so each
+    // callback pairs a sample number with an upper bound on when it was acquired: exactly
+    // what the clock model's lower envelope is built for. Resync whenever the sample
+    // count restarts.
+    if (sampleRate <= 0.0f)
+        return;
+
+    if (blockEndSample <= module->m_lastBlockEndSample)
+        module->m_sampleClock.reset();
+
+    module->m_sampleClock.setNominalRate(1.0e9 / sampleRate, sampleRate);
+    module->m_sampleClock.addObservation(double(blockEndSample), double(callbackTimeNs));
+    module->m_lastBlockEndSample = blockEndSample;
+}
 
-    lock.exit();
-    m_positionIsUpdated = false;
+int TrackingNode::getSampleOffset (TrackingNodeSettings* module, int64 receiveTimeNs,
+                                   int64 firstSampleInBlock, uint32 numSamplesInBlock) const
+{
+    if (! module->m_sampleClock.isValid())
+        return 0;
+
+    // Messages that arrived before this block started (e.g. while the previous callback
+    // ran late) or that map past its end are pinned to the block's edges.
+    const double sample = module->m_sampleClock.unmap(double(receiveTimeNs));
+    const double offset = std::floor(sample - double(firstSampleInBlock));
 
+    return int(jlimit(0.0, double(numSamplesInBlock - 1), offset));
 }
 
 int TrackingNode::getTrackingNodeSettingsIndex(int port, String address)
@@ -358,65 +603,44 @@ int TrackingNode::getNSources()
     //return TrackingNodeSettings.size ();
 }
 
-void TrackingNode::receiveMessage (int port, String address, const TrackingData &message)
+bool TrackingNode::isReady()
 {
-    //int index = getTrackingNodeSettingsIndex(port, address);
-    //if (index != -1)
-    //{
-    //    auto *selectedModule = TrackingNodeSettings.getReference (index);
-
-    //    lock.enter();
-
-    //    if (CoreServices::getRecordingStatus())
-    //    {
-    //        if (!m_isRecordingTimeLogged)
-    //        {
-    //            m_received_msg = 0;
-    //            m_startingRecTimeMillis =  Time::currentTimeMillis();
-    //            m_isRecordingTimeLogged = true;
-    //            std::cout << "Starting Recording Ts: " << m_startingRecTimeMillis << std::endl;
-    //            selectedModule->m_messageQueue->clear();
-    //            CoreServices::sendStatusMessage ("Clearing queue before start recording");
-    //        }
-    //    }
-    //    else
-    //    {
-    //        m_isRecordingTimeLogged = false;
-    //    }
-
-
-    //    if (CoreServices::getAcquisitionStatus()) // && !CoreServices::getRecordingStatus())
-    //    {
-    //        if (!m_isAcquisitionTimeLogged)
-    //        {
-    //            m_startingAcqTimeMillis = Time::currentTimeMillis();
-    //            m_isAcquisitionTimeLogged = true;
-    //            std::cout << "Starting Acquisition at Ts: " << m_startingAcqTimeMillis << std::endl;
-    //            selectedModule->m_messageQueue->clear();
-    //            CoreServices::sendStatusMessage ("Clearing queue before start acquisition");
-    //        }
-
-    //        m_positionIsUpdated = true;
-
-    //        // NOTE: We cannot trust the getGlobalTimestamp function because it can return
-    //        // negative time deltas. The reason is unknown.
-    //        int64 ts = CoreServices::getSoftwareTimestamp();
-
-    //        TrackingData outputMessage = message;
-    //        outputMessage.timestamp = ts;
-    //        selectedModule->m_messageQueue->push (outputMessage);
-    //        m_received_msg++;
-    //    }
-    //    else
-    //        m_isAcquisitionTimeLogged = false;
-
-    //    lock.exit();
-    //}
+    return true;
+}
 
+bool TrackingNode::getIngestStatus (uint16 streamId, TrackingStatsMonitor& monitor)
+{
+    TrackingNodeSettings* module = settings[streamId];
+    if (module == nullptr || module->m_messageQueue == nullptr)
+        return false;
+
+    TrackingIngestStatus& status = monitor.getStatus();
+    monitor.update(module->m_stats, getTrackingClockNs());
+
+    const TrackingQueue* queue = module->m_messageQueue;
+    status.drops = queue->getDropCount();
+    status.queueDepth = queue->getSize();
+    status.queueHighWaterMark = queue->getHighWaterMark();
+    status.queueCapacity = queue->getCapacity();
+    return true;
 }
 
-bool TrackingNode::isReady()
+bool TrackingNode::stopAcquisition()
 {
+    for (auto stream : getDataStreams()) {
+        auto* module = settings[stream->getStreamId()];
+        auto* queue = module->m_messageQueue;
+
+        if (queue->getDropCount() > 0)
+            cout << "Tracking Port: source " << module->m_address << " dropped " << queue->getDropCount()
+                 << " positions (queue capacity " << queue->getCapacity()
+                 << ", high-water mark " << queue->getHighWaterMark() << ")" << endl;
+
+        module->updateQueue();
+        module->updateCalibration();
+        module->updateMetadata();
+        module->m_kinematics.reset();
+    }
     return true;
 }
 
@@ -453,158 +677,3 @@ void TrackingNode::loadCustomParametersFromXml (XmlElement* xml)
         }
     }*/
 }
-
-// Class TrackingQueue methods
-TrackingQueue::TrackingQueue()
-    : m_head (-1)
-    , m_tail (-1)
-{
-    memset (m_buffer, 0, BUFFER_SIZE);
-}
-
-TrackingQueue::~TrackingQueue() {}
-
-void TrackingQueue::push (const TrackingData &message)
-{
-    m_head = (m_head + 1) % BUFFER_SIZE;
-    m_buffer[m_head] = message;
-}
-
-TrackingData* TrackingQueue::pop ()
-{
-    if (isEmpty())
-        return nullptr;
-
-    m_tail = (m_tail + 1) % BUFFER_SIZE;
-    return &(m_buffer[m_tail]);
-
-}
-
-bool TrackingQueue::isEmpty()
-{
-    return m_head == m_tail;
-}
-
-void TrackingQueue::clear()
-{
-    m_tail = -1;
-    m_head = -1;
-}
-
-// Class TrackingServer methods
-TrackingServer::TrackingServer ()
-    : Thread ("OscListener Thread")
-    , m_incomingPort (0)
-    , m_address ("")
-{
-}
-
-TrackingServer::TrackingServer (int port, String address)
-    : Thread ("OscListener Thread")
-    , m_incomingPort (port)
-    , m_address (address)
-{
-}
-
-TrackingServer::~TrackingServer()
-{
-    cout << "Destructing tracking server" << endl;
-    // stop the OSC Listener thread running
-    //    m_listeningSocket->Break();
-    // allow the thread 2 seconds to stop cleanly - should be plenty of time.
-    cout << "Destructed tracking server" << endl;
-    delete m_listeningSocket;
-}
-
-void TrackingServer::ProcessMessage (const osc::ReceivedMessage& receivedMessage,
-                                     const IpEndpointName&)
-{
-    int64 ts = CoreServices::getGlobalTimestamp();
-    try
-    {
-        uint32 argumentCount = 4;
-
-        if ( receivedMessage.ArgumentCount() != argumentCount) {
-            cout << "ERROR: TrackingServer received message with wrong number of arguments. "
-                 << "Expected " << argumentCount << ", got " << receivedMessage.ArgumentCount() << endl;
-            return;
-        }
-
-        for (uint32 i = 0; i < receivedMessage.ArgumentCount(); i++)
-        {
-            if (receivedMessage.TypeTags()[i] != 'f')
-            {
-                cout << "TrackingServer only support 'f' (floats), not '"
-                     << receivedMessage.TypeTags()[i] << "'" << endl;
-                return;
-            }
-        }
-
-        osc::ReceivedMessageArgumentStream args = receivedMessage.ArgumentStream();
-
-        TrackingData trackingData;
-
-        // Arguments:
-        args >> trackingData.position.x; // 0 - x
-        args >> trackingData.position.y; // 1 - y
-        args >> trackingData.position.width; // 2 - box width
-        args >> trackingData.position.height; // 3 - box height
-        args >> osc::EndMessage;
-
-        for (TrackingNode* processor : m_processors)
-        {
-            //            String address = processor->address();
-
-            if ( std::strcmp ( receivedMessage.AddressPattern(), m_address.toStdString().c_str() ) != 0 )
-            {
-                continue;
-            }
-            // add TrackingNodeSettings to receive message call: processor->receiveMessage (m_incomingPort, m_address, trackingData);
-            processor->receiveMessage (m_incomingPort, m_address, trackingData);
-        }
-    }
-    catch ( osc::Exception& e )
-    {
-        // any parsing errors such as unexpected argument types, or
-        // missing arguments get thrown as exceptions.
-        DBG ("error while parsing message: " << receivedMessage.AddressPattern() << ": " << e.what() << "\n");
-    }
-}
-
-void TrackingServer::addProcessor (TrackingNode* processor)
-{
-    m_processors.push_back (processor);
-}
-
-void TrackingServer::removeProcessor (TrackingNode* processor)
-{
-    m_processors.erase (std::remove (m_processors.begin(), m_processors.end(), processor), m_processors.end());
-}
-
-void TrackingServer::run()
-{
-    cout << "SLeeping!" << endl;
-    sleep(1000);
-    cout << "Running!" << endl;
-    // Start the oscpack OSC Listener Thread
-    try {
-        m_listeningSocket = new UdpListeningReceiveSocket(IpEndpointName("localhost", m_incomingPort), this);
-        sleep(1000);
-        m_listeningSocket->Run();
-    }
-    catch (const std::exception& e)
-    {
-        std::cout << "Exception in TrackingServer::run(): " << e.what() << std::endl;
-    }
-}
-
-void TrackingServer::stop()
-{
-    // Stop the oscpack OSC Listener Thread
-    if (!isThreadRunning())
-    {
-        return;
-    }
-
-    m_listeningSocket->AsynchronousBreak();
-}
@@ -34,110 +34,70 @@
 
 #include <ProcessorHeaders.h>
 #include "TrackingMessage.h"
-
-#include "oscpack/osc/OscOutboundPacketStream.h"
-#include "oscpack/ip/IpEndpointName.h"
-#include "oscpack/osc/OscReceivedElements.h"
-#include "oscpack/osc/OscPacketListener.h"
-#include "oscpack/ip/UdpSocket.h"
+#include "TrackingServer.h"
+#include "TrackingFilter.h"
+#include "TrackingValidator.h"
+#include "TrackingCalibration.h"
+#include "TrackingKinematics.h"
 
 #include <stdio.h>
 #include <queue>
 #include <utility>
 
-#define BUFFER_SIZE 4096
-#define MAX_SOURCES 10
 #define DEF_PORT 27020
 #define DEF_ADDRESS "/red"
 #define DEF_COLOR "red"
 
 using namespace std;
 
-/**
-    This helper class allows stores input tracking data in a circular queue.
-*/
-class TrackingQueue
-{
-public:
-
-    TrackingQueue();
-    ~TrackingQueue();
-
-    void push (const TrackingData &message);
-    TrackingData *pop();
-
-    bool isEmpty();
-    void clear();
-
-private:
-    TrackingData m_buffer[BUFFER_SIZE];
-    int m_head;
-    int m_tail;
-};
-
-/**
-    This helper class is an OSC server running its own thread to keep data transmission
-    continuous.
-*/
-
-class TrackingNode;
-
-class TrackingServer: public osc::OscPacketListener,
-    public Thread
-{
-public:
-    TrackingServer ();
-    TrackingServer (int port, String address);
-    ~TrackingServer();
-
-    void run();
-    void stop();
-
-    void addProcessor (TrackingNode* processor);
-    void removeProcessor (TrackingNode* processor);
-
-protected:
-    virtual void ProcessMessage (const osc::ReceivedMessage& m, const IpEndpointName&);
-
-private:
-    TrackingServer (TrackingServer const&);
-    void operator= (TrackingServer const&);
-
-    int m_incomingPort;
-    String m_address;
-
-    UdpListeningReceiveSocket *m_listeningSocket = nullptr;
-    std::vector<TrackingNode*> m_processors;
-};
-
 // Hold the settings for the TrackingNode
 class TrackingNodeSettings
 {
 public:
     TrackingNodeSettings();
-    ~TrackingNodeSettings() {
-        if (m_messageQueue)
-        {
-            cout << "Deleting message queue" << endl;
-            delete m_messageQueue;
-        }
-        if (m_server)
-        {
-            m_server->stop();
-            cout << "Stopping thread" << endl;
-            m_server->stopThread(-1);
-            cout << "Waiting for exit" << endl;
-            m_server->waitForThreadToExit(-1);
-            cout << "Delete server" << endl;
-            delete m_server;
-        }
-    }
+    ~TrackingNodeSettings();
+
+    /** (Re)registers this source's queue with the shared server for the current port and address. */
+    void connect();
+    /**
+        Replaces the queue if its capacity or overflow policy no longer match the settings.
+        Must not be called while the audio thread may be reading the queue.
+    */
+    void updateQueue();
+    /** Rebuilds the metadata attached to every event after the color, port or address changed. */
+    void updateMetadata();
+    /**
+        Loads m_calibrationFile, or clears the calibration if it is empty.
+        Must not be called while the audio thread may be calibrating positions.
+    */
+    void updateCalibration();
+
     int m_port = -1;
     String m_address;
     String m_color;
+    timestamp_mode m_timestampMode = arrival_time;
+    int m_queueCapacity = BUFFER_SIZE;
+    overflow_policy m_overflowPolicy = drop_oldest;
     TrackingQueue* m_messageQueue = nullptr;
-    TrackingServer* m_server = nullptr;
+    TrackingSourceStats m_stats;
+    SharedResourcePointer<TrackingServer> m_server;
+    // validated, calibrated and filtered positions, the positions as received so recordings keep
+    // them, the tracking_quality of every position and the TrackingMotion at every position
     EventChannel* eventChannel;
+    EventChannel* rawEventChannel;
+    EventChannel* qualityEventChannel;
+    EventChannel* kinematicsEventChannel;
+    String m_calibrationFile;
+    TrackingCalibration m_calibration;
+    TrackingValidator m_validator;
+    TrackingFilter m_filter;
+    TrackingKinematics m_kinematics;
+    // color, port and address of the source; built once, attached to every data event
+    MetadataValueArray m_metadata;
+
+    // tracking clock (ns) against this stream's sample numbers
+    TrackingClockModel m_sampleClock;
+    int64 m_lastBlockEndSample = -1;
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TrackingNodeSettings);
 };
 
@@ -158,13 +118,13 @@ public:
     void updateSettings() override;
     void process (AudioSampleBuffer&) override;
     bool isReady();
+    bool stopAcquisition() override;
     /** Called when a parameter is updated*/
     void parameterValueChanged(Parameter* param) override;
 
     void saveCustomParametersToXml(XmlElement* parentElement) override;
     void loadCustomParametersFromXml(XmlElement* parentElement) override;
 
-    void receiveMessage (int port, String address, const TrackingData &message);
     int getTrackingNodeSettingsIndex(int port, String address);
     void addSource (int port, String address, String color);
     void addSource ();
@@ -179,13 +139,22 @@ public:
     void setColor (int i, String color);
     String getColor(int i);
 
+    /**
+        Refreshes monitor with the ingest statistics of the source feeding streamId.
+        Returns false if the stream has no source. Message thread only (the editor's timer):
+        updateQueue() replaces the source's queue from that thread when acquisition stops.
+    */
+    bool getIngestStatus (uint16 streamId, TrackingStatsMonitor& monitor);
+
 private:
+    /** Adds the current block to the stream's tracking clock to sample number model. */
+    void updateSampleClock (TrackingNodeSettings* module, float sampleRate, int64 blockEndSample, int64 callbackTimeNs);
+    /** Offset within the current block of the sample acquired at receiveTimeNs. */
+    int getSampleOffset (TrackingNodeSettings* module, int64 receiveTimeNs, int64 firstSampleInBlock, uint32 numSamplesInBlock) const;
+
     int64 m_startingRecTimeMillis;
     int64 m_startingAcqTimeMillis;
 
-    CriticalSection lock;
-
-    bool m_positionIsUpdated;
     bool m_isRecordingTimeLogged;
     bool m_isAcquisitionTimeLogged;   
     int m_received_msg;
@@ -35,8 +35,9 @@
 TrackingNodeEditor::TrackingNodeEditor (GenericProcessor* parentNode)
     : GenericEditor (parentNode)
     , selectedSource(0)
+    , statsStreamId(0)
 {
-    desiredWidth = 220;
+    desiredWidth = 645;
 
     TrackingNode* processor = (TrackingNode*) getProcessor();
     auto src_param = processor->getParameter("Source");
@@ -44,11 +45,59 @@ TrackingNodeEditor::TrackingNodeEditor (GenericProcessor* parentNode)
     addSelectedChannelsParameterEditor("Port", 10, 55);
     addTextBoxParameterEditor("Address", 10, 80);
     addComboBoxParameterEditor("Color", 10, 105);
-
+    addTextBoxParameterEditor("Queue", 120, 55);
+    addComboBoxParameterEditor("Overflow", 120, 80);
+    addComboBoxParameterEditor("Timestamps", 120, 105);
+    addComboBoxParameterEditor("Filter", 225, 55);
+    addTextBoxParameterEditor("Cutoff", 225, 80);
+    addTextBoxParameterEditor("Calibration", 225, 105);
+    addTextBoxParameterEditor("Max speed", 330, 55);
+    addTextBoxParameterEditor("Fill", 330, 80);
+    addComboBoxParameterEditor("Bounds", 330, 105);
+    addTextBoxParameterEditor("Window", 435, 55);
+
+    statsLabel = new Label("Ingest statistics", "");
+    statsLabel->setBounds(540, 30, 100, 95);
+    statsLabel->setFont(Font("Small Text", 11, Font::plain));
+    statsLabel->setJustificationType(Justification::topLeft);
+    statsLabel->setColour(Label::textColourId, Colours::darkgrey);
+    addAndMakeVisible(statsLabel);
+
+    startTimer(1000);
 }
 
 TrackingNodeEditor::~TrackingNodeEditor()
 {
+    stopTimer();
+}
+
+void TrackingNodeEditor::timerCallback()
+{
+    TrackingNode* processor = (TrackingNode*) getProcessor();
+    const uint16 streamId = getCurrentStream();
+
+    if (streamId != statsStreamId)
+    {
+        statsMonitor.reset();
+        statsStreamId = streamId;
+    }
+
+    if (! processor->getIngestStatus(streamId, statsMonitor))
+    {
+        statsLabel->setText("", dontSendNotification);
+        return;
+    }
+
+    const TrackingIngestStatus& status = statsMonitor.getStatus();
+    String text;
+    text << String(status.messagesPerSecond, 1) << " msg/s\n"
+         << "errors " << String(status.parseErrors) << " / " << String(status.wrongArity) << "\n"
+         << "queue " << String((int) status.queueDepth) << " (max " << String((int) status.queueHighWaterMark) << ")\n"
+         << "dropped " << String(status.drops) << "\n"
+         << "interval " << String(status.intervalMs[0], 1) << " ms\n"
+         << "p95/p99 " << String(status.intervalMs[1], 1) << "/" << String(status.intervalMs[2], 1);
+
+    statsLabel->setText(text, dontSendNotification);
 }
 /*
 void TrackingNodeEditor::labelTextChanged (Label* label)
@@ -96,7 +145,7 @@ void TrackingNodeEditor::updateLabels()
     labelAdr->setText(p->getAddress(selectedSource), dontSendNotification);
     labelPort->setText(String(p->getPort(selectedSource)), dontSendNotification);
 
-    for (int i=0; i < MAX_SOURCES; i++)
+    for (int i=0; i < color_palette.size(); i++)
     {
         if (color_palette[i].compare(p->getColor(selectedSource))==0)
             colorSelector->setSelectedId(i+1);
@@ -106,12 +155,12 @@ void TrackingNodeEditor::updateLabels()
 void TrackingNodeEditor::buttonEvent(Button* button)
 {
     /*TrackingNode* p = (TrackingNode*) getProcessor();
-    if (button == plusButton && p->getNSources() < MAX_SOURCES)
+    if (button == plusButton)
         addTrackingSource();
     else if (button == minusButton && p->getNSources() > 1)
         removeTrackingSource();
     else
-        CoreServices::sendStatusMessage("Number of sources must be between 1 and 10!");
+        CoreServices::sendStatusMessage("At least one source is required!");
     CoreServices::updateSignalChain(this);*/
 }
 
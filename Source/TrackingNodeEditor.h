@@ -32,14 +32,14 @@
 #ifndef TRACKINGNODEEDITOR_H
 #define TRACKINGNODEEDITOR_H
 
-#define MAX_SOURCES 10
-
 #include <EditorHeaders.h>
+#include "TrackingSourceStats.h"
 
 class TrackingNodeEditor :
         public GenericEditor,
         public Label::Listener,
-        public ComboBox::Listener
+        public ComboBox::Listener,
+        public Timer
 {
 public:
     TrackingNodeEditor (GenericProcessor* parentNode);
@@ -52,6 +52,9 @@ public:
     virtual void updateSettings();
     //void updateLabels();
 
+    /** Refreshes the ingest statistics of the selected stream's source. */
+    void timerCallback() override;
+
 private:
 	Array<String> color_palette;
     int selectedSource;
@@ -67,6 +70,9 @@ private:
     ScopedPointer<Label> labelColor;
     ScopedPointer<Label> colorLabel;
     ScopedPointer<ComboBox> colorSelector;
+    ScopedPointer<Label> statsLabel;
+    TrackingStatsMonitor statsMonitor;
+    uint16 statsStreamId;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TrackingNodeEditor);
 
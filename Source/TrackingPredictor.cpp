@@ -0,0 +1,243 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Tracking plugin for the Open Ephys GUI
+    Written by:
+
+    Alessio Buccino     alessiob@ifi.uio.no
+    Mikkel Lepperod
+    Svenn-Arne Dragly
+
+    Center for Integrated Neuroplasticity CINPLA
+    Department of Biosciences
+    University of Oslo
+    Norway
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TrackingPredictor.h"
+
+#include <algorithm>
+
+TrackingPredictor::TrackingPredictor (prediction_model model)
+    : m_model (model)
+    , m_processNoise (getDefaultProcessNoise (model))
+    , m_measurementNoise (1.0e-5)
+    , m_maxGap (0.5)
+    , m_maxHorizon (0.25)
+    , m_isValid (false)
+    , m_lastTime (0.0)
+{
+}
+
+void TrackingPredictor::setModel (prediction_model model)
+{
+    if (model == m_model)
+        return;
+
+    m_model = model;
+    m_processNoise = getDefaultProcessNoise (model);
+    reset();
+}
+
+prediction_model TrackingPredictor::getModel() const
+{
+    return m_model;
+}
+
+void TrackingPredictor::setNoise (double processNoise, double measurementNoise)
+{
+    m_processNoise = processNoise;
+    m_measurementNoise = measurementNoise;
+}
+
+void TrackingPredictor::setLimits (double maxGap, double maxHorizon)
+{
+    m_maxGap = maxGap;
+    m_maxHorizon = maxHorizon;
+}
+
+double TrackingPredictor::getDefaultProcessNoise (prediction_model model)
+{
+    // tuned on a simulated run at 0.3 to 1 arena widths per second, 30 Hz frames
+    // with a few mm of jitter: lower values lag turns, higher ones amplify jitter
+    return model == constant_acceleration ? 30.0 : 3.0;
+}
+
+void TrackingPredictor::reset()
+{
+    m_isValid = false;
+}
+
+bool TrackingPredictor::isValid() const
+{
+    return m_isValid;
+}
+
+int TrackingPredictor::getOrder() const
+{
+    return m_model == constant_acceleration ? 3 : 2;
+}
+
+void TrackingPredictor::update (double time, float x, float y)
+{
+    if (m_model == no_prediction)
+    {
+        initialise (m_x, x);
+        initialise (m_y, y);
+        m_lastTime = time;
+        m_isValid = true;
+        return;
+    }
+
+    const double dt = time - m_lastTime;
+
+    if (! m_isValid || dt > m_maxGap)
+    {
+        initialise (m_x, x);
+        initialise (m_y, y);
+        m_lastTime = time;
+        m_isValid = true;
+        return;
+    }
+
+    if (dt < 0.0)
+        return;
+
+    propagate (m_x, dt);
+    propagate (m_y, dt);
+    correct (m_x, x);
+    correct (m_y, y);
+    m_lastTime = time;
+}
+
+bool TrackingPredictor::predict (double time, float& x, float& y) const
+{
+    if (! m_isValid)
+        return false;
+
+    const double dt = m_model == no_prediction ? 0.0 : std::min (std::max (time - m_lastTime, 0.0), m_maxHorizon);
+    x = float (extrapolate (m_x, dt));
+    y = float (extrapolate (m_y, dt));
+    return true;
+}
+
+void TrackingPredictor::initialise (Axis& axis, double position) const
+{
+    for (int i = 0; i < MAX_ORDER; i++)
+    {
+        axis.state[i] = 0.0;
+        for (int j = 0; j < MAX_ORDER; j++)
+            axis.covariance[i][j] = 0.0;
+    }
+    axis.state[0] = position;
+
+    // the position is known to the measurement noise, its derivatives not at all
+    axis.covariance[0][0] = m_measurementNoise;
+    axis.covariance[1][1] = 1.0;
+    axis.covariance[2][2] = 100.0;
+}
+
+void TrackingPredictor::propagate (Axis& axis, double dt) const
+{
+    const int n = getOrder();
+    const double transition[MAX_ORDER][MAX_ORDER] = {
+        { 1.0, dt, 0.5 * dt * dt },
+        { 0.0, 1.0, dt },
+        { 0.0, 0.0, 1.0 }
+    };
+
+    double state[MAX_ORDER] = { 0.0, 0.0, 0.0 };
+    for (int i = 0; i < n; i++)
+        for (int k = 0; k < n; k++)
+            state[i] += transition[i][k] * axis.state[k];
+
+    // F P F'
+    double temp[MAX_ORDER][MAX_ORDER] = {};
+    double covariance[MAX_ORDER][MAX_ORDER] = {};
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < n; j++)
+            for (int k = 0; k < n; k++)
+                temp[i][j] += transition[i][k] * axis.covariance[k][j];
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < n; j++)
+            for (int k = 0; k < n; k++)
+                covariance[i][j] += temp[i][k] * transition[j][k];
+
+    // discretised white noise on the highest derivative
+    const double q = m_processNoise;
+    const double dt2 = dt * dt;
+    const double dt3 = dt2 * dt;
+    if (n == 2)
+    {
+        covariance[0][0] += q * dt3 / 3.0;
+        covariance[0][1] += q * dt2 / 2.0;
+        covariance[1][0] += q * dt2 / 2.0;
+        covariance[1][1] += q * dt;
+    }
+    else
+    {
+        const double dt4 = dt3 * dt;
+        const double dt5 = dt4 * dt;
+        const double noise[MAX_ORDER][MAX_ORDER] = {
+            { dt5 / 20.0, dt4 / 8.0, dt3 / 6.0 },
+            { dt4 / 8.0, dt3 / 3.0, dt2 / 2.0 },
+            { dt3 / 6.0, dt2 / 2.0, dt }
+        };
+        for (int i = 0; i < n; i++)
+            for (int j = 0; j < n; j++)
+                covariance[i][j] += q * noise[i][j];
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        axis.state[i] = state[i];
+        for (int j = 0; j < n; j++)
+            axis.covariance[i][j] = covariance[i][j];
+    }
+}
+
+void TrackingPredictor::correct (Axis& axis, double position) const
+{
+    const int n = getOrder();
+
+    // only the position is measured, so the innovation and its variance are scalars
+    const double innovation = position - axis.state[0];
+    const double variance = axis.covariance[0][0] + m_measurementNoise;
+
+    double gain[MAX_ORDER];
+    for (int i = 0; i < n; i++)
+        gain[i] = axis.covariance[i][0] / variance;
+
+    for (int i = 0; i < n; i++)
+        axis.state[i] += gain[i] * innovation;
+
+    double firstRow[MAX_ORDER];
+    for (int j = 0; j < n; j++)
+        firstRow[j] = axis.covariance[0][j];
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < n; j++)
+            axis.covariance[i][j] -= gain[i] * firstRow[j];
+}
+
+double TrackingPredictor::extrapolate (const Axis& axis, double dt) const
+{
+    double position = axis.state[0] + axis.state[1] * dt;
+    if (getOrder() == 3)
+        position += 0.5 * axis.state[2] * dt * dt;
+    return position;
+}
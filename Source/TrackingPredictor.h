@@ -0,0 +1,109 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Tracking plugin for the Open Ephys GUI
+    Written by:
+
+    Alessio Buccino     alessiob@ifi.uio.no
+    Mikkel Lepperod
+    Svenn-Arne Dragly
+
+    Center for Integrated Neuroplasticity CINPLA
+    Department of Biosciences
+    University of Oslo
+    Norway
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACKINGPREDICTOR_H
+#define TRACKINGPREDICTOR_H
+
+typedef enum
+{
+  no_prediction,
+  constant_velocity,
+  constant_acceleration
+} prediction_model;
+
+/**
+    Per-source Kalman filter that extrapolates a tracked position to a later time.
+
+    Each axis keeps an independent position, velocity (and, for the constant
+    acceleration model, acceleration) state. Positions are filtered as they arrive
+    and predict() extrapolates the state to any later time, so decisions can be made
+    on where the animal is now rather than where it was when the frame was taken.
+
+    Times are in seconds on any clock, as long as update() and predict() share it.
+    processNoise is the spectral density of the white noise driving the highest
+    derivative (acceleration for constant_velocity, jerk for constant_acceleration);
+    measurementNoise is the variance of a position measurement. A gap longer than
+    maxGap seconds between positions restarts the filter, and predictions are never
+    extrapolated further than maxHorizon seconds past the last position.
+*/
+class TrackingPredictor
+{
+public:
+    TrackingPredictor (prediction_model model = constant_velocity);
+
+    void setModel (prediction_model model);
+    prediction_model getModel() const;
+
+    void setNoise (double processNoise, double measurementNoise);
+    void setLimits (double maxGap, double maxHorizon);
+
+    /** Default process noise for model, in normalised arena units. */
+    static double getDefaultProcessNoise (prediction_model model);
+
+    /** Forgets the state; the next position starts the filter over. */
+    void reset();
+
+    /** Adds the position measured at time. Positions older than the last one are ignored. */
+    void update (double time, float x, float y);
+
+    /** Position extrapolated to time. Returns false, leaving x and y untouched, before the first position. */
+    bool predict (double time, float& x, float& y) const;
+
+    bool isValid() const;
+
+private:
+    static const int MAX_ORDER = 3;
+
+    struct Axis
+    {
+        double state[MAX_ORDER];
+        double covariance[MAX_ORDER][MAX_ORDER];
+    };
+
+    int getOrder() const;
+    void initialise (Axis& axis, double position) const;
+    void propagate (Axis& axis, double dt) const;
+    void correct (Axis& axis, double position) const;
+    double extrapolate (const Axis& axis, double dt) const;
+
+    prediction_model m_model;
+    double m_processNoise;
+    double m_measurementNoise;
+    double m_maxGap;
+    double m_maxHorizon;
+
+    bool m_isValid;
+    double m_lastTime;
+    Axis m_x;
+    Axis m_y;
+};
+
+#endif // TRACKINGPREDICTOR_H
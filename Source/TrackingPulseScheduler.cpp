@@ -0,0 +1,100 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Tracking plugin for the Open Ephys GUI
+    Written by:
+
+    Alessio Buccino     alessiob@ifi.uio.no
+    Mikkel Lepperod
+    Svenn-Arne Dragly
+
+    Center for Integrated Neuroplasticity CINPLA
+    Department of Biosciences
+    University of Oslo
+    Norway
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TrackingPulseScheduler.h"
+
+#include <algorithm>
+
+TrackingPulseScheduler::TrackingPulseScheduler()
+    : m_level(0)
+    , m_pulseSamples(1)
+    , m_periodSamples(1)
+    , m_pulses(1)
+{
+    setTrain(m_pulseSamples, m_periodSamples, m_pulses);
+}
+
+void TrackingPulseScheduler::setTrain(int64_t pulseSamples, int64_t periodSamples, int pulses)
+{
+    m_pulseSamples = std::max<int64_t>(1, pulseSamples);
+    m_periodSamples = std::max<int64_t>(1, periodSamples);
+    m_pulses = std::max(1, pulses);
+    m_pending.reserve(size_t(2 * m_pulses * MAX_QUEUED_TRAINS));
+}
+
+bool TrackingPulseScheduler::trigger(int64_t start)
+{
+    if (m_pending.size() + 2 * m_pulses > m_pending.capacity())
+        return false;
+
+    for (int p = 0; p < m_pulses; p++)
+    {
+        int64_t onset = start + p * m_periodSamples;
+
+        m_pending.push_back({ onset, 1 });
+        std::push_heap(m_pending.begin(), m_pending.end());
+        m_pending.push_back({ onset + m_pulseSamples, -1 });
+        std::push_heap(m_pending.begin(), m_pending.end());
+    }
+    return true;
+}
+
+bool TrackingPulseScheduler::nextEdge(int64_t end, TrackingPulseEdge& edge)
+{
+    while (!m_pending.empty() && m_pending.front().sample < end)
+    {
+        const Pending next = m_pending.front();
+        std::pop_heap(m_pending.begin(), m_pending.end());
+        m_pending.pop_back();
+
+        const int previous = m_level;
+        m_level += next.delta;
+
+        if ((previous == 0) != (m_level == 0))
+        {
+            edge.sample = next.sample;
+            edge.on = m_level > 0;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TrackingPulseScheduler::isOn() const
+{
+    return m_level > 0;
+}
+
+void TrackingPulseScheduler::clear()
+{
+    m_pending.clear();
+    m_level = 0;
+}
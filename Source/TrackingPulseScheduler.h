@@ -0,0 +1,100 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Tracking plugin for the Open Ephys GUI
+    Written by:
+
+    Alessio Buccino     alessiob@ifi.uio.no
+    Mikkel Lepperod
+    Svenn-Arne Dragly
+
+    Center for Integrated Neuroplasticity CINPLA
+    Department of Biosciences
+    University of Oslo
+    Norway
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACKINGPULSESCHEDULER_H
+#define TRACKINGPULSESCHEDULER_H
+
+#include <cstdint>
+#include <vector>
+
+#define MAX_QUEUED_TRAINS 64
+
+/** A TTL transition at an absolute sample number. */
+struct TrackingPulseEdge
+{
+    int64_t sample;
+    bool on;
+};
+
+/**
+    Sample-accurate TTL pulse trains, independent of the processor and of JUCE.
+
+    trigger() queues the ON and OFF edges of a train of pulses at absolute sample
+    numbers; nextEdge() hands them back block by block, so a train may span any
+    number of blocks and every edge lands on its exact sample. Overlapping pulses,
+    from trains triggered close together, merge into one: only the transitions of
+    the combined output are returned.
+*/
+class TrackingPulseScheduler
+{
+public:
+    TrackingPulseScheduler();
+
+    /** Pulses of pulseSamples every periodSamples, pulses per trigger. Applies to later triggers.
+        Reserves room for MAX_QUEUED_TRAINS such trains, so that trigger() never allocates. */
+    void setTrain(int64_t pulseSamples, int64_t periodSamples, int pulses);
+
+    /** Queues a train whose first pulse starts at sample start. Returns false, and drops the
+        train, if MAX_QUEUED_TRAINS trains are already queued. */
+    bool trigger(int64_t start);
+
+    /** Pops the next output transition before sample end, false if there is none. */
+    bool nextEdge(int64_t end, TrackingPulseEdge& edge);
+
+    /** True while the output is high. */
+    bool isOn() const;
+
+    /** Drops the queued edges and lowers the output. If isOn() was true, the caller
+        has to send the closing OFF edge itself. */
+    void clear();
+
+private:
+    // min-heap on sample; at equal samples ON first, so that back-to-back pulses merge
+    struct Pending
+    {
+        int64_t sample;
+        int delta;
+
+        bool operator< (const Pending& other) const
+        {
+            return sample != other.sample ? sample > other.sample : delta < other.delta;
+        }
+    };
+
+    std::vector<Pending> m_pending;
+    int m_level;
+
+    int64_t m_pulseSamples;
+    int64_t m_periodSamples;
+    int m_pulses;
+};
+
+#endif // TRACKINGPULSESCHEDULER_H
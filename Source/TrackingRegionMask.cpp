@@ -0,0 +1,156 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Tracking plugin for the Open Ephys GUI
+    Written by:
+
+    Alessio Buccino     alessiob@ifi.uio.no
+    Mikkel Lepperod
+    Svenn-Arne Dragly
+
+    Center for Integrated Neuroplasticity CINPLA
+    Department of Biosciences
+    University of Oslo
+    Norway
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TrackingRegionMask.h"
+
+#include <algorithm>
+#include <cmath>
+
+TrackingRegionMask::TrackingRegionMask()
+    : m_resolution (DEF_MASK_RESOLUTION)
+{
+    build (std::vector<const StimArea*>());
+}
+
+void TrackingRegionMask::setResolution (int cells)
+{
+    m_resolution = std::max (1, std::min (MAX_MASK_RESOLUTION, cells));
+}
+
+int TrackingRegionMask::getResolution() const
+{
+    return m_resolution;
+}
+
+void TrackingRegionMask::build (const std::vector<const StimArea*>& regions)
+{
+    m_regions = regions;
+    m_cells = m_resolution;
+    m_labels.assign (m_cells * m_cells, NO_REGION);
+
+    const float cellSize = 1.0f / m_cells;
+    const float halfDiagonal = cellSize * 0.7072f;
+
+    // cell range covered by a region's bounding box, one cell of margin for rounding
+    auto getRange = [this] (const StimArea* region, int& i0, int& j0, int& i1, int& j1)
+    {
+        float xMin, yMin, xMax, yMax;
+        region->getBounds (xMin, yMin, xMax, yMax);
+        i0 = std::max (0, int (std::floor (xMin * m_cells)) - 1);
+        j0 = std::max (0, int (std::floor (yMin * m_cells)) - 1);
+        i1 = std::min (m_cells - 1, int (std::floor (xMax * m_cells)) + 1);
+        j1 = std::min (m_cells - 1, int (std::floor (yMax * m_cells)) + 1);
+    };
+
+    // paint the last region first so that lower indices take precedence: a cell the region
+    // covers entirely gets its index, a cell its outline crosses becomes an edge, and a cell
+    // it misses entirely keeps whatever a later region left there
+    for (int r = int (regions.size()) - 1; r >= 0; r--)
+    {
+        int i0, j0, i1, j1;
+        getRange (regions[r], i0, j0, i1, j1);
+
+        for (int j = j0; j <= j1; j++)
+        {
+            const float y = (j + 0.5f) * cellSize;
+            for (int i = i0; i <= i1; i++)
+            {
+                const float x = (i + 0.5f) * cellSize;
+                if (regions[r]->distanceFromEdge (x, y) <= halfDiagonal)
+                    m_labels[j * m_cells + i] = EDGE;
+                else if (regions[r]->isPositionIn (x, y))
+                    m_labels[j * m_cells + i] = r;
+            }
+        }
+    }
+
+    // number the edge cells and list, in region order, the regions near each of them
+    int nEdges = 0;
+    for (int& label : m_labels)
+    {
+        if (label == EDGE)
+            label = EDGE - nEdges++;
+    }
+
+    m_edgeStart.assign (nEdges + 1, 0);
+    for (int pass = 0; pass < 2; pass++)
+    {
+        for (int r = 0; r < int (regions.size()); r++)
+        {
+            int i0, j0, i1, j1;
+            getRange (regions[r], i0, j0, i1, j1);
+
+            for (int j = j0; j <= j1; j++)
+            {
+                for (int i = i0; i <= i1; i++)
+                {
+                    const int label = m_labels[j * m_cells + i];
+                    if (label > EDGE)
+                        continue;
+                    const int edge = EDGE - label;
+                    if (pass == 0)
+                        m_edgeStart[edge + 1]++;
+                    else
+                        m_edgeItems[m_edgeStart[edge]++] = r;
+                }
+            }
+        }
+
+        if (pass == 0)
+        {
+            for (int e = 0; e < nEdges; e++)
+                m_edgeStart[e + 1] += m_edgeStart[e];
+            m_edgeItems.assign (m_edgeStart[nEdges], 0);
+        }
+        else
+        {
+            // filling advanced every start to the next one's
+            for (int e = nEdges; e > 0; e--)
+                m_edgeStart[e] = m_edgeStart[e - 1];
+            m_edgeStart[0] = 0;
+        }
+    }
+}
+
+int TrackingRegionMask::getLabel (int i, int j) const
+{
+    return m_labels[j * m_cells + i];
+}
+
+int TrackingRegionMask::findExact (float x, float y) const
+{
+    for (int r = 0; r < int (m_regions.size()); r++)
+    {
+        if (m_regions[r]->isPositionIn (x, y))
+            return r;
+    }
+    return NO_REGION;
+}
@@ -0,0 +1,109 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Tracking plugin for the Open Ephys GUI
+    Written by:
+
+    Alessio Buccino     alessiob@ifi.uio.no
+    Mikkel Lepperod
+    Svenn-Arne Dragly
+
+    Center for Integrated Neuroplasticity CINPLA
+    Department of Biosciences
+    University of Oslo
+    Norway
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACKINGREGIONMASK_H
+#define TRACKINGREGIONMASK_H
+
+#include "TrackingStimAreas.h"
+
+#include <algorithm>
+#include <vector>
+
+#define DEF_MASK_RESOLUTION 256
+#define MAX_MASK_RESOLUTION 2048
+
+/**
+    The stimulation regions rasterized into a label mask over the unit square, so
+    hit-testing a position is a single array lookup.
+
+    Each cell holds the index of the first region covering all of it, or nothing.
+    Cells crossed by a region's outline are marked as edges and keep the short
+    list of regions whose bounding box overlaps them; only there is the exact
+    geometry tested, in region order, so find() returns the same index as a linear
+    scan at any resolution. Positions outside the unit square are scanned linearly.
+
+    The regions are referenced, not copied: rebuild whenever they change or move.
+*/
+class TrackingRegionMask
+{
+public:
+    TrackingRegionMask();
+
+    /** Cells per side, clamped to [1, MAX_MASK_RESOLUTION]. Takes effect on the next build(). */
+    void setResolution (int cells);
+    int getResolution() const;
+
+    void build (const std::vector<const StimArea*>& regions);
+
+    /** Index of the first region containing (x, y), -1 if there is none. */
+    int find (float x, float y) const
+    {
+        if (! (x >= 0.0f && x < 1.0f && y >= 0.0f && y < 1.0f))
+            return findExact (x, y);
+
+        const int i = std::min (int (x * m_cells), m_cells - 1);
+        const int j = std::min (int (y * m_cells), m_cells - 1);
+        const int label = m_labels[j * m_cells + i];
+        if (label >= NO_REGION)
+            return label;
+
+        const int edge = EDGE - label;
+        for (int k = m_edgeStart[edge]; k < m_edgeStart[edge + 1]; k++)
+        {
+            if (m_regions[m_edgeItems[k]]->isPositionIn (x, y))
+                return m_edgeItems[k];
+        }
+        return NO_REGION;
+    }
+
+    /** Label of cell (i, j): a region index, -1 for no region, or < -1 for an edge cell. */
+    int getLabel (int i, int j) const;
+
+private:
+    enum
+    {
+        NO_REGION = -1,
+        EDGE = -2
+    };
+
+    int findExact (float x, float y) const;
+
+    std::vector<const StimArea*> m_regions;
+    std::vector<int> m_labels;
+    // candidates of edge cell EDGE - label, in region order
+    std::vector<int> m_edgeStart;
+    std::vector<int> m_edgeItems;
+
+    int m_resolution;
+    int m_cells;
+};
+
+#endif // TRACKINGREGIONMASK_H
@@ -0,0 +1,636 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Tracking plugin for the Open Ephys GUI
+    Written by:
+
+    Alessio Buccino     alessiob@ifi.uio.no
+    Mikkel Lepperod
+    Svenn-Arne Dragly
+
+    Center for Integrated Neuroplasticity CINPLA
+    Department of Biosciences
+    University of Oslo
+    Norway
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TrackingServer.h"
+#include "TrackingMessageDecoder.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+// Class TrackingQueue methods
+size_t TrackingQueue::getCapacityFor (size_t requested, overflow_policy policy)
+{
+    if (policy == keep_latest)
+        return 1;
+
+    size_t capacity = 2;
+    while (capacity < requested)
+        capacity <<= 1;
+    return capacity;
+}
+
+TrackingQueue::TrackingQueue (size_t capacity, overflow_policy policy)
+    : m_capacity (getCapacityFor (capacity, policy))
+    , m_indexMask (m_capacity - 1)
+    , m_policy (policy)
+    , m_buffer (new TrackingData[m_capacity]())
+    , m_head (0)
+    , m_cachedTail (0)
+    , m_dropCount (0)
+    , m_highWaterMark (0)
+    , m_tail (0)
+    , m_cachedHead (0)
+{
+}
+
+TrackingQueue::~TrackingQueue() {}
+
+bool TrackingQueue::push (const TrackingData &message)
+{
+    if (m_policy == keep_latest)
+        return pushLatest (message);
+
+    const size_t head = m_head.load (std::memory_order_relaxed);
+    bool dropped = false;
+
+    if (head - m_cachedTail == m_capacity)
+    {
+        m_cachedTail = m_tail.load (std::memory_order_acquire);
+        if (head - m_cachedTail == m_capacity)
+        {
+            if (m_policy == drop_newest)
+            {
+                m_dropCount.fetch_add (1, std::memory_order_relaxed);
+                return false;
+            }
+
+            // Claim the oldest entry the same way the consumer does. If the consumer
+            // gets there first, its pop has made room and nothing is lost.
+            size_t tail = m_cachedTail;
+            dropped = m_tail.compare_exchange_strong (tail, tail + 1,
+                                                      std::memory_order_acq_rel,
+                                                      std::memory_order_acquire);
+            m_cachedTail = dropped ? tail + 1 : tail;
+
+            if (dropped)
+                m_dropCount.fetch_add (1, std::memory_order_relaxed);
+        }
+    }
+
+    m_buffer[head & m_indexMask] = message;
+    m_head.store (head + 1, std::memory_order_release);
+
+    // The cached tail lags behind the consumer, so it overstates the depth: refresh it
+    // before raising the mark. This only happens when the mark might grow.
+    if (head + 1 - m_cachedTail > m_highWaterMark.load (std::memory_order_relaxed))
+    {
+        m_cachedTail = m_tail.load (std::memory_order_acquire);
+        updateHighWaterMark (head + 1 - m_cachedTail);
+    }
+    return ! dropped;
+}
+
+bool TrackingQueue::pop (TrackingData &message)
+{
+    if (m_policy == keep_latest)
+        return popLatest (message);
+
+    size_t tail = m_tail.load (std::memory_order_relaxed);
+
+    for (;;)
+    {
+        // the producer may have moved the tail past our cached head by dropping entries
+        if (tail == m_cachedHead || m_cachedHead - tail > m_capacity)
+        {
+            m_cachedHead = m_head.load (std::memory_order_acquire);
+            if (tail == m_cachedHead)
+                return false;
+        }
+
+        message = m_buffer[tail & m_indexMask];
+
+        if (m_policy == drop_newest)
+        {
+            m_tail.store (tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        // A failed exchange means the producer dropped this entry (and may have
+        // overwritten it) while it was being copied: retry with the new tail.
+        if (m_tail.compare_exchange_weak (tail, tail + 1,
+                                          std::memory_order_acq_rel,
+                                          std::memory_order_acquire))
+            return true;
+    }
+}
+
+bool TrackingQueue::pushLatest (const TrackingData &message)
+{
+    // m_head is the slot's sequence number: odd while a write is in progress.
+    // m_tail is the sequence number the consumer read last.
+    const size_t sequence = m_head.load (std::memory_order_relaxed);
+    const bool dropped = sequence != 0 && m_tail.load (std::memory_order_relaxed) != sequence;
+
+    m_head.store (sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence (std::memory_order_release);
+    m_buffer[0] = message;
+    m_head.store (sequence + 2, std::memory_order_release);
+
+    if (dropped)
+        m_dropCount.fetch_add (1, std::memory_order_relaxed);
+
+    updateHighWaterMark (1);
+    return ! dropped;
+}
+
+bool TrackingQueue::popLatest (TrackingData &message)
+{
+    for (;;)
+    {
+        const size_t sequence = m_head.load (std::memory_order_acquire);
+        if (sequence == m_tail.load (std::memory_order_relaxed))
+            return false;
+        if (sequence & 1)
+            continue;
+
+        message = m_buffer[0];
+        std::atomic_thread_fence (std::memory_order_acquire);
+
+        if (m_head.load (std::memory_order_relaxed) == sequence)
+        {
+            m_tail.store (sequence, std::memory_order_release);
+            return true;
+        }
+    }
+}
+
+void TrackingQueue::updateHighWaterMark (size_t size)
+{
+    // only the producer writes the mark
+    if (size > m_highWaterMark.load (std::memory_order_relaxed))
+        m_highWaterMark.store (size, std::memory_order_relaxed);
+}
+
+bool TrackingQueue::isEmpty() const
+{
+    const size_t tail = m_tail.load (std::memory_order_relaxed);
+    const size_t head = m_head.load (std::memory_order_acquire);
+
+    if (m_policy == keep_latest)
+        return (head & ~size_t (1)) == tail;
+
+    return head == tail;
+}
+
+void TrackingQueue::clear()
+{
+    if (m_policy == keep_latest)
+    {
+        m_tail.store (m_head.load (std::memory_order_acquire) & ~size_t (1), std::memory_order_release);
+        return;
+    }
+
+    const size_t head = m_head.load (std::memory_order_acquire);
+    size_t tail = m_tail.load (std::memory_order_relaxed);
+    m_cachedHead = head;
+
+    while (tail < head
+           && ! m_tail.compare_exchange_weak (tail, head, std::memory_order_acq_rel, std::memory_order_relaxed))
+    {
+    }
+}
+
+size_t TrackingQueue::getCapacity() const
+{
+    return m_capacity;
+}
+
+overflow_policy TrackingQueue::getOverflowPolicy() const
+{
+    return m_policy;
+}
+
+size_t TrackingQueue::getSize() const
+{
+    if (m_policy == keep_latest)
+        return isEmpty() ? 0 : 1;
+
+    const size_t tail = m_tail.load (std::memory_order_relaxed);
+    const size_t head = m_head.load (std::memory_order_relaxed);
+    return head > tail ? std::min (head - tail, m_capacity) : 0;
+}
+
+uint64_t TrackingQueue::getDropCount() const
+{
+    return m_dropCount.load (std::memory_order_relaxed);
+}
+
+size_t TrackingQueue::getHighWaterMark() const
+{
+    return m_highWaterMark.load (std::memory_order_relaxed);
+}
+
+// Class TrackingPort methods
+TrackingPort::TrackingPort (int port)
+    : m_incomingPort (port)
+    , m_socket (IpEndpointName ("localhost", port))
+{
+}
+
+TrackingPort::~TrackingPort() {}
+
+int TrackingPort::getPort() const
+{
+    return m_incomingPort;
+}
+
+UdpSocket* TrackingPort::getSocket()
+{
+    return &m_socket;
+}
+
+void TrackingPort::addSource (const std::string& address, TrackingQueue* queue, TrackingSourceStats* stats, timestamp_mode mode)
+{
+    // sender seconds onto tracking clock nanoseconds
+    m_sources.push_back ({ address, queue, stats, mode, TrackingClockModel (1.0e9) });
+    updateRoutes();
+}
+
+void TrackingPort::removeSource (TrackingQueue* queue)
+{
+    m_sources.erase (std::remove_if (m_sources.begin(), m_sources.end(),
+                                     [queue] (const Source& source) { return source.queue == queue; }),
+                     m_sources.end());
+    updateRoutes();
+}
+
+void TrackingPort::updateRoutes()
+{
+    bool enable = false;
+    m_routes.clear();
+
+    for (auto& source : m_sources)
+    {
+        m_routes.add (source.address, { source.queue, source.stats, source.timestampMode, &source.clock });
+        // the sender clock model is fitted against kernel arrival times where available
+        enable = enable || source.timestampMode != arrival_time;
+    }
+
+    if (enable != m_receiveTimestampsEnabled)
+    {
+        m_socket.SetEnableReceiveTimestamps (enable);
+        m_receiveTimestampsEnabled = enable;
+    }
+}
+
+void TrackingPort::ProcessPacketBatch (const ReceivedDatagram* datagrams, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        m_packetReceiveTimeNs = datagrams[i].receiveTimeNs;
+        ProcessPacket (datagrams[i].data, datagrams[i].size, datagrams[i].remoteEndpoint);
+    }
+    m_packetReceiveTimeNs = 0;
+}
+
+int64_t TrackingPort::getKernelReceiveTime (int64_t arrivalTimeNs) const
+{
+    if (m_packetReceiveTimeNs <= 0)
+        return arrivalTimeNs;
+
+    // Kernel stamps are CLOCK_REALTIME: the difference to the current real time is
+    // how long the packet waited between reaching the socket and being parsed.
+    // Move the arrival time back by that much.
+    const int64_t nowNs = std::chrono::duration_cast<std::chrono::nanoseconds> (
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    return arrivalTimeNs - std::max (int64_t (0), int64_t (nowNs - m_packetReceiveTimeNs));
+}
+
+int64_t TrackingPort::getSenderReceiveTime (TrackingClockModel& clock, double frameTime, int64_t arrivalTimeNs) const
+{
+    if (std::isnan (frameTime))
+        return arrivalTimeNs;
+
+    clock.addObservation (frameTime, double (arrivalTimeNs));
+
+    // never place a frame later than it arrived
+    return std::min (arrivalTimeNs, int64_t (std::llround (clock.map (frameTime))));
+}
+
+bool TrackingPort::hasSources() const
+{
+    return ! m_sources.empty();
+}
+
+void TrackingPort::ProcessPacket (const char* data, int size, const IpEndpointName& remoteEndpoint)
+{
+    const char* address;
+    size_t addressLength;
+    TrackingPosition position;
+    double frameTime;
+
+    if (decodeTrackingMessage (data, size, address, addressLength, position, frameTime))
+    {
+        deliver (address, addressLength, position, frameTime);
+        return;
+    }
+
+    // Anything other than a plain ",ffff" message (bundles, other argument
+    // types) goes through the full oscpack parser.
+    try
+    {
+        osc::OscPacketListener::ProcessPacket (data, size, remoteEndpoint);
+    }
+    catch ( osc::Exception& )
+    {
+        // the address is unknown: count it against every source on this port
+        recordError (nullptr, false);
+    }
+}
+
+void TrackingPort::ProcessBundle (const osc::ReceivedBundle& b, const IpEndpointName& remoteEndpoint)
+{
+    // Messages inside a bundle are stamped with its time tag. Nested bundles
+    // carry their own; a time tag of 1 means "immediately" and carries no time.
+    const uint64_t outerTimeTag = m_bundleTimeTag;
+    m_bundleTimeTag = b.TimeTag();
+
+    osc::OscPacketListener::ProcessBundle (b, remoteEndpoint);
+
+    m_bundleTimeTag = outerTimeTag;
+}
+
+void TrackingPort::ProcessMessage (const osc::ReceivedMessage& receivedMessage,
+                                   const IpEndpointName&)
+{
+    try
+    {
+        const osc::uint32 argumentCount = 4;
+
+        // an optional fifth argument carries the frame time, in seconds ('d') or as a time tag ('t')
+        const bool hasFrameTime = receivedMessage.ArgumentCount() == argumentCount + 1
+                                  && (receivedMessage.TypeTags()[argumentCount] == 'd'
+                                      || receivedMessage.TypeTags()[argumentCount] == 't');
+
+        if ( receivedMessage.ArgumentCount() != argumentCount && ! hasFrameTime) {
+            recordError (receivedMessage.AddressPattern(), true);
+            return;
+        }
+
+        for (osc::uint32 i = 0; i < argumentCount; i++)
+        {
+            if (receivedMessage.TypeTags()[i] != 'f')
+            {
+                recordError (receivedMessage.AddressPattern(), true);
+                return;
+            }
+        }
+
+        osc::ReceivedMessageArgumentStream args = receivedMessage.ArgumentStream();
+
+        TrackingPosition position;
+
+        // Arguments:
+        args >> position.x; // 0 - x
+        args >> position.y; // 1 - y
+        args >> position.width; // 2 - box width
+        args >> position.height; // 3 - box height
+
+        double frameTime = std::numeric_limits<double>::quiet_NaN();
+
+        if (hasFrameTime && receivedMessage.TypeTags()[argumentCount] == 'd')
+        {
+            args >> frameTime; // 4 - frame time (s)
+        }
+        else if (hasFrameTime)
+        {
+            osc::TimeTag timeTag;
+            args >> timeTag; // 4 - frame time (time tag)
+            frameTime = timeTagToSeconds (timeTag.value);
+        }
+        else if (m_bundleTimeTag > 1)
+        {
+            frameTime = timeTagToSeconds (m_bundleTimeTag);
+        }
+
+        args >> osc::EndMessage;
+
+        deliver (receivedMessage.AddressPattern(), std::strlen (receivedMessage.AddressPattern()), position, frameTime);
+    }
+    catch ( osc::Exception& )
+    {
+        // any parsing errors such as unexpected argument types, or
+        // missing arguments get thrown as exceptions.
+        recordError (receivedMessage.AddressPattern(), false);
+    }
+}
+
+void TrackingPort::deliver (const char* address, size_t addressLength, const TrackingPosition& position, double frameTime)
+{
+    const auto* routes = m_routes.find (address, addressLength);
+    if (routes == nullptr)
+        return;
+
+    const int64_t now = getTrackingClockNs();
+
+    TrackingData trackingData;
+    trackingData.timestamp = 0;
+    trackingData.position = position;
+
+    for (auto& route : *routes)
+    {
+        switch (route.timestampMode)
+        {
+            case kernel_time:
+                trackingData.receiveTimeNs = getKernelReceiveTime (now);
+                break;
+            case sender_time:
+                trackingData.receiveTimeNs = getSenderReceiveTime (*route.clock, frameTime, getKernelReceiveTime (now));
+                break;
+            default:
+                trackingData.receiveTimeNs = now;
+                break;
+        }
+        route.stats->recordMessage (now);
+        route.queue->push (trackingData);
+    }
+}
+
+void TrackingPort::recordError (const char* address, bool wrongArity)
+{
+    if (address == nullptr)
+    {
+        for (auto& source : m_sources)
+            source.stats->recordParseError();
+        return;
+    }
+
+    const auto* routes = m_routes.find (address, std::strlen (address));
+    if (routes == nullptr)
+        return;
+
+    for (auto& route : *routes)
+    {
+        if (wrongArity)
+            route.stats->recordWrongArity();
+        else
+            route.stats->recordParseError();
+    }
+}
+
+// Class TrackingServer methods
+TrackingServer::TrackingServer()
+    : m_shouldExit (false)
+    , m_thread (&TrackingServer::run, this)
+{
+}
+
+TrackingServer::~TrackingServer()
+{
+    std::cout << "Destructing tracking server" << std::endl;
+    m_shouldExit = true;
+    m_multiplexer.AsynchronousBreak();
+    m_thread.join();
+    std::cout << "Destructed tracking server" << std::endl;
+}
+
+void TrackingServer::addSource (int port, const std::string& address, TrackingQueue* queue, TrackingSourceStats* stats, timestamp_mode mode)
+{
+    submit ({ true, port, address, queue, stats, mode });
+}
+
+void TrackingServer::removeSource (TrackingQueue* queue)
+{
+    submit ({ false, -1, std::string(), queue, nullptr, arrival_time });
+}
+
+void TrackingServer::submit (const Request& request)
+{
+    int64_t ticket;
+    {
+        std::lock_guard<std::mutex> lock (m_requestLock);
+        m_requests.push_back (request);
+        ticket = ++m_requestsSubmitted;
+    }
+
+    // Sockets can only be attached while the multiplexer is not running:
+    // break out of it and wait for the reactor thread to apply the request.
+    m_multiplexer.AsynchronousBreak();
+
+    std::unique_lock<std::mutex> lock (m_requestLock);
+    m_requestsAppliedCondition.wait (lock, [this, ticket] { return m_requestsApplied >= ticket || ! m_running; });
+}
+
+void TrackingServer::applyRequests()
+{
+    std::vector<Request> requests;
+    int64_t submitted;
+    {
+        std::lock_guard<std::mutex> lock (m_requestLock);
+        requests.swap (m_requests);
+        submitted = m_requestsSubmitted;
+    }
+
+    for (auto& request : requests)
+    {
+        if (request.add)
+        {
+            TrackingPort* port = nullptr;
+            for (auto& p : m_ports)
+            {
+                if (p->getPort() == request.port)
+                    port = p.get();
+            }
+
+            if (port == nullptr)
+            {
+                try
+                {
+                    m_ports.emplace_back (new TrackingPort (request.port));
+                }
+                catch (const std::runtime_error& e)
+                {
+                    std::cout << "Could not open tracking port " << request.port << ": " << e.what() << std::endl;
+                    continue;
+                }
+                port = m_ports.back().get();
+                m_multiplexer.AttachSocketListener (port->getSocket(), port);
+            }
+            port->addSource (request.address, request.queue, request.stats, request.timestampMode);
+        }
+        else
+        {
+            for (auto it = m_ports.begin(); it != m_ports.end();)
+            {
+                (*it)->removeSource (request.queue);
+                if (! (*it)->hasSources())
+                {
+                    detachPort (it->get());
+                    it = m_ports.erase (it);
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> lock (m_requestLock);
+    m_requestsApplied = submitted;
+    m_requestsAppliedCondition.notify_all();
+}
+
+void TrackingServer::detachPort (TrackingPort* port)
+{
+    m_multiplexer.DetachSocketListener (port->getSocket(), port);
+}
+
+void TrackingServer::run()
+{
+    while (! m_shouldExit)
+    {
+        applyRequests();
+
+        try
+        {
+            m_multiplexer.Run();
+        }
+        catch (const std::exception& e)
+        {
+            std::cout << "Exception in TrackingServer::run(): " << e.what() << std::endl;
+            std::this_thread::sleep_for (std::chrono::milliseconds (100));
+        }
+    }
+
+    for (auto& port : m_ports)
+        detachPort (port.get());
+    m_ports.clear();
+
+    std::lock_guard<std::mutex> lock (m_requestLock);
+    m_running = false;
+    m_requestsAppliedCondition.notify_all();
+}
@@ -0,0 +1,264 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Tracking plugin for the Open Ephys GUI
+    Written by:
+
+    Alessio Buccino     alessiob@ifi.uio.no
+    Mikkel Lepperod
+    Svenn-Arne Dragly
+
+    Center for Integrated Neuroplasticity CINPLA
+    Department of Biosciences
+    University of Oslo
+    Norway
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACKINGSERVER_H
+#define TRACKINGSERVER_H
+
+#include "TrackingData.h"
+#include "TrackingDispatchTable.h"
+#include "TrackingClockModel.h"
+#include "TrackingSourceStats.h"
+
+#include "oscpack/osc/OscReceivedElements.h"
+#include "oscpack/osc/OscPacketListener.h"
+#include "oscpack/ip/UdpSocket.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define BUFFER_SIZE 4096 // default queue capacity
+
+typedef enum
+{
+  arrival_time,
+  kernel_time,
+  sender_time
+} timestamp_mode;
+
+typedef enum
+{
+  drop_oldest,
+  drop_newest,
+  keep_latest
+} overflow_policy;
+
+/**
+    Wait-free single-producer/single-consumer ring buffer holding the tracking data of
+    one source. The OSC thread is the only producer and the audio thread the only
+    consumer, so neither side ever blocks the other. Head and tail indices live on
+    separate cache lines, and each side keeps a cached copy of the other side's index
+    so that the shared line is only touched when the cached value runs out.
+
+    The capacity is rounded up to a power of two. What happens when the producer finds
+    the queue full depends on the overflow policy:
+      - drop_oldest: the producer discards the oldest unread message (a CAS on the tail,
+        which the consumer also claims entries with) and stores the new one
+      - drop_newest: the new message is discarded
+      - keep_latest: the queue degenerates to a single seqlock-protected slot that
+        always holds the most recent message, for consumers that only need the
+        current position
+    Every discarded message is counted, and the producer records the deepest the queue
+    has ever been, so overflows are visible while they happen.
+*/
+class TrackingQueue
+{
+public:
+
+    TrackingQueue (size_t capacity = BUFFER_SIZE, overflow_policy policy = drop_oldest);
+    ~TrackingQueue();
+
+    /** Producer side. Returns false if a message (the new or an older one) was dropped. */
+    bool push (const TrackingData &message);
+    /** Consumer side. Returns false if the queue is empty. */
+    bool pop (TrackingData &message);
+
+    bool isEmpty() const;
+    /** Consumer side. Discards every message currently in the queue. */
+    void clear();
+
+    size_t getCapacity() const;
+    overflow_policy getOverflowPolicy() const;
+    /** Capacity a queue created with these arguments ends up with. */
+    static size_t getCapacityFor (size_t requested, overflow_policy policy);
+    /** Number of unread messages (approximate while the producer is running). */
+    size_t getSize() const;
+    /** Total number of messages dropped because the queue was full. */
+    uint64_t getDropCount() const;
+    /** Largest number of unread messages ever held. */
+    size_t getHighWaterMark() const;
+
+private:
+    static const size_t CACHE_LINE_SIZE = 64;
+
+    bool pushLatest (const TrackingData &message);
+    bool popLatest (TrackingData &message);
+    void updateHighWaterMark (size_t size);
+
+    const size_t m_capacity;
+    const size_t m_indexMask;
+    const overflow_policy m_policy;
+    std::unique_ptr<TrackingData[]> m_buffer;
+
+    // written by the producer
+    std::atomic<size_t> m_head;
+    size_t m_cachedTail;
+    std::atomic<uint64_t> m_dropCount;
+    std::atomic<size_t> m_highWaterMark;
+    char m_producerPad[CACHE_LINE_SIZE];
+
+    // written by the consumer (and by the producer when dropping the oldest message)
+    std::atomic<size_t> m_tail;
+    size_t m_cachedHead;
+    char m_consumerPad[CACHE_LINE_SIZE];
+};
+
+/**
+    Socket bound to one tracking port. Every message received on it is pushed into the
+    queue of each source registered for the message's OSC address.
+*/
+class TrackingPort : public osc::OscPacketListener
+{
+public:
+    TrackingPort (int port);
+    ~TrackingPort();
+
+    int getPort() const;
+    UdpSocket* getSocket();
+
+    void addSource (const std::string& address, TrackingQueue* queue, TrackingSourceStats* stats, timestamp_mode mode);
+    void removeSource (TrackingQueue* queue);
+    bool hasSources() const;
+
+    void ProcessPacketBatch (const ReceivedDatagram* datagrams, int count) override;
+    void ProcessPacket (const char* data, int size, const IpEndpointName& remoteEndpoint) override;
+
+protected:
+    virtual void ProcessMessage (const osc::ReceivedMessage& m, const IpEndpointName&);
+    void ProcessBundle (const osc::ReceivedBundle& b, const IpEndpointName& remoteEndpoint) override;
+
+private:
+    struct Source
+    {
+        std::string address;
+        TrackingQueue* queue;
+        TrackingSourceStats* stats;
+        timestamp_mode timestampMode;
+        // maps the sender's frame times onto acquisition timestamps (sender_time only)
+        TrackingClockModel clock;
+    };
+
+    struct Route
+    {
+        TrackingQueue* queue;
+        TrackingSourceStats* stats;
+        timestamp_mode timestampMode;
+        TrackingClockModel* clock;
+    };
+
+    /**
+        Pushes a decoded position into the queue of every source registered for address.
+        frameTime is the sender's time for the frame in seconds, NaN if it did not send one.
+    */
+    void deliver (const char* address, size_t addressLength, const TrackingPosition& position, double frameTime);
+    void updateRoutes();
+    /** Counts a malformed message against the sources registered for address (all sources if null). */
+    void recordError (const char* address, bool wrongArity);
+    int64_t getKernelReceiveTime (int64_t arrivalTimeNs) const;
+    int64_t getSenderReceiveTime (TrackingClockModel& clock, double frameTime, int64_t arrivalTimeNs) const;
+
+    int m_incomingPort;
+    UdpReceiveSocket m_socket;
+    std::vector<Source> m_sources;
+    TrackingDispatchTable<Route> m_routes;
+    bool m_receiveTimestampsEnabled = false;
+
+    // kernel arrival time of the datagram being processed, 0 if unknown
+    long long m_packetReceiveTimeNs = 0;
+
+    // time tag of the innermost bundle being processed, 0 outside bundles
+    uint64_t m_bundleTimeTag = 0;
+
+    TrackingPort (const TrackingPort&) = delete;
+    TrackingPort& operator= (const TrackingPort&) = delete;
+};
+
+/**
+    Single OSC reactor shared by every Tracking Port: one thread owns the sockets of all
+    tracking ports and dispatches incoming messages to the per-source queues. Sources are
+    attached and detached at runtime, so adding a source only binds a socket (or reuses
+    the one already bound to its port) instead of spawning a thread.
+
+    In the plugin it is accessed through SharedResourcePointer<TrackingServer>, so the
+    reactor lives as long as at least one source holds a pointer to it. It has no other
+    dependency on JUCE or the GUI and can be run headless.
+*/
+class TrackingServer
+{
+public:
+    TrackingServer();
+    ~TrackingServer();
+
+    /** Starts delivering messages sent to port/address into queue, counting them in stats. */
+    void addSource (int port, const std::string& address, TrackingQueue* queue, TrackingSourceStats* stats, timestamp_mode mode);
+    /** Stops delivering messages into queue. The reactor no longer touches the queue once this returns. */
+    void removeSource (TrackingQueue* queue);
+
+private:
+    struct Request
+    {
+        bool add;
+        int port;
+        std::string address;
+        TrackingQueue* queue;
+        TrackingSourceStats* stats;
+        timestamp_mode timestampMode;
+    };
+
+    void run();
+    void submit (const Request& request);
+    void applyRequests();
+    void detachPort (TrackingPort* port);
+
+    SocketReceiveMultiplexer m_multiplexer;
+    std::vector<std::unique_ptr<TrackingPort>> m_ports;
+
+    std::mutex m_requestLock;
+    std::condition_variable m_requestsAppliedCondition;
+    std::vector<Request> m_requests;
+    int64_t m_requestsSubmitted = 0;
+    int64_t m_requestsApplied = 0;
+    bool m_running = true;
+
+    std::atomic<bool> m_shouldExit;
+    // started last, once everything above is constructed
+    std::thread m_thread;
+
+    TrackingServer (const TrackingServer&) = delete;
+    TrackingServer& operator= (const TrackingServer&) = delete;
+};
+
+#endif // TRACKINGSERVER_H
@@ -0,0 +1,207 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Tracking plugin for the Open Ephys GUI
+    Written by:
+
+    Alessio Buccino     alessiob@ifi.uio.no
+    Mikkel Lepperod
+    Svenn-Arne Dragly
+
+    Center for Integrated Neuroplasticity CINPLA
+    Department of Biosciences
+    University of Oslo
+    Norway
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACKINGSOURCESTATS_H
+#define TRACKINGSOURCESTATS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+    Ingest counters of one tracking source. The receive thread is the only writer;
+    any thread may read them at any time. Every counter is a relaxed atomic that
+    only grows, so readers get rates and distributions by differencing two reads
+    (see TrackingStatsMonitor) and never stall the receive thread.
+*/
+class TrackingSourceStats
+{
+public:
+    static const int NUM_INTERVAL_BINS = 512;
+    // inter-arrival histogram resolution; the last bin collects everything longer
+    static constexpr double INTERVAL_BIN_MS = 0.25;
+
+    TrackingSourceStats()
+        : m_messages (0)
+        , m_parseErrors (0)
+        , m_wrongArity (0)
+        , m_lastArrivalNs (0)
+    {
+        for (auto& bin : m_intervals)
+            bin.store (0, std::memory_order_relaxed);
+    }
+
+    /** Receive thread: a position for this source arrived at nowNs. */
+    void recordMessage (int64_t nowNs)
+    {
+        m_messages.fetch_add (1, std::memory_order_relaxed);
+
+        if (m_lastArrivalNs > 0)
+        {
+            const double intervalMs = (nowNs - m_lastArrivalNs) * 1e-6;
+            int bin = int (intervalMs / INTERVAL_BIN_MS);
+            bin = bin < 0 ? 0 : (bin >= NUM_INTERVAL_BINS ? NUM_INTERVAL_BINS - 1 : bin);
+            m_intervals[bin].fetch_add (1, std::memory_order_relaxed);
+        }
+        m_lastArrivalNs = nowNs;
+    }
+
+    /** Receive thread: a packet that may have been meant for this source could not be parsed. */
+    void recordParseError()
+    {
+        m_parseErrors.fetch_add (1, std::memory_order_relaxed);
+    }
+
+    /** Receive thread: a message for this source had the wrong number or type of arguments. */
+    void recordWrongArity()
+    {
+        m_wrongArity.fetch_add (1, std::memory_order_relaxed);
+    }
+
+    uint64_t getMessageCount() const     { return m_messages.load (std::memory_order_relaxed); }
+    uint64_t getParseErrorCount() const  { return m_parseErrors.load (std::memory_order_relaxed); }
+    uint64_t getWrongArityCount() const  { return m_wrongArity.load (std::memory_order_relaxed); }
+
+    uint32_t getIntervalCount (int bin) const
+    {
+        return m_intervals[bin].load (std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> m_messages;
+    std::atomic<uint64_t> m_parseErrors;
+    std::atomic<uint64_t> m_wrongArity;
+    std::atomic<uint32_t> m_intervals[NUM_INTERVAL_BINS];
+
+    // receive thread only
+    int64_t m_lastArrivalNs;
+};
+
+/** What a TrackingStatsMonitor reports about a source. */
+struct TrackingIngestStatus
+{
+    double messagesPerSecond = 0.0;
+    uint64_t messages = 0;
+    uint64_t parseErrors = 0;
+    uint64_t wrongArity = 0;
+    uint64_t drops = 0;
+    size_t queueDepth = 0;
+    size_t queueHighWaterMark = 0;
+    size_t queueCapacity = 0;
+    // inter-arrival time percentiles (50th, 95th, 99th) since the previous update, in ms
+    double intervalMs[3] = { 0.0, 0.0, 0.0 };
+};
+
+/**
+    Reader side of TrackingSourceStats: keeps the previous read so each update()
+    reports rates and inter-arrival percentiles over the interval since the last
+    one. Each reader owns its own monitor.
+*/
+class TrackingStatsMonitor
+{
+public:
+    TrackingStatsMonitor()
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        m_lastUpdateNs = 0;
+        m_lastMessages = 0;
+        for (auto& count : m_lastIntervals)
+            count = 0;
+    }
+
+    const TrackingIngestStatus& update (const TrackingSourceStats& stats, int64_t nowNs)
+    {
+        const uint64_t messages = stats.getMessageCount();
+
+        // a smaller count than last time means the stats block was replaced
+        if (messages < m_lastMessages)
+            reset();
+
+        if (m_lastUpdateNs > 0 && nowNs > m_lastUpdateNs)
+            m_status.messagesPerSecond = (messages - m_lastMessages) * 1e9 / double (nowNs - m_lastUpdateNs);
+
+        m_status.messages = messages;
+        m_status.parseErrors = stats.getParseErrorCount();
+        m_status.wrongArity = stats.getWrongArityCount();
+
+        uint32_t intervals[TrackingSourceStats::NUM_INTERVAL_BINS];
+        uint64_t total = 0;
+
+        for (int i = 0; i < TrackingSourceStats::NUM_INTERVAL_BINS; i++)
+        {
+            const uint32_t count = stats.getIntervalCount (i);
+            intervals[i] = count - m_lastIntervals[i];
+            m_lastIntervals[i] = count;
+            total += intervals[i];
+        }
+
+        static const double quantiles[3] = { 0.5, 0.95, 0.99 };
+
+        for (int q = 0; q < 3; q++)
+            m_status.intervalMs[q] = total > 0 ? getQuantile (intervals, total, quantiles[q]) : 0.0;
+
+        m_lastMessages = messages;
+        m_lastUpdateNs = nowNs;
+        return m_status;
+    }
+
+    /** The status returned by the last update(), for filling in the queue fields. */
+    TrackingIngestStatus& getStatus()
+    {
+        return m_status;
+    }
+
+private:
+    static double getQuantile (const uint32_t* intervals, uint64_t total, double quantile)
+    {
+        const double target = quantile * double (total);
+        uint64_t cumulative = 0;
+
+        for (int i = 0; i < TrackingSourceStats::NUM_INTERVAL_BINS; i++)
+        {
+            cumulative += intervals[i];
+            if (double (cumulative) >= target)
+                return (i + 0.5) * TrackingSourceStats::INTERVAL_BIN_MS;
+        }
+        return TrackingSourceStats::NUM_INTERVAL_BINS * TrackingSourceStats::INTERVAL_BIN_MS;
+    }
+
+    TrackingIngestStatus m_status;
+    int64_t m_lastUpdateNs;
+    uint64_t m_lastMessages;
+    uint32_t m_lastIntervals[TrackingSourceStats::NUM_INTERVAL_BINS];
+};
+
+#endif // TRACKINGSOURCESTATS_H
@@ -0,0 +1,386 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Tracking plugin for the Open Ephys GUI
+    Written by:
+
+    Alessio Buccino     alessiob@ifi.uio.no
+    Mikkel Lepperod
+    Svenn-Arne Dragly
+
+    Center for Integrated Neuroplasticity CINPLA
+    Department of Biosciences
+    University of Oslo
+    Norway
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TrackingStimAreas.h"
+
+#include <algorithm>
+#include <cmath>
+
+static constexpr float pi = 3.14159265358979323846f;
+
+// StimArea methods
+
+
+StimArea::StimArea() :
+    m_cx(0),
+    m_cy(0),
+    m_on(false)
+{
+}
+
+StimArea::StimArea(float x, float y, bool on) :
+    m_cx(x),
+    m_cy(y),
+    m_on(on)
+{
+}
+
+float StimArea::getX() const
+{
+    return m_cx;
+}
+float StimArea::getY() const
+{
+    return m_cy;
+}
+bool StimArea::getOn() const
+{
+    return m_on;
+}
+
+void StimArea::setX(float x)
+{
+    m_cx = x;
+}
+void StimArea::setY(float y)
+{
+    m_cy = y;
+}
+
+bool StimArea::on()
+{
+    m_on = true;
+    return m_on;
+}
+bool StimArea::off()
+{
+    m_on = false;
+    return m_on;
+}
+
+// Circle methods
+
+StimCircle::StimCircle()
+    : m_rad(0), StimArea(0, 0, false)
+{
+}
+
+StimCircle::StimCircle(float x, float y, float rad, bool on) : StimArea(x, y, on)
+{
+    m_rad = rad;
+}
+
+float StimCircle::getRad() const
+{
+    return m_rad;
+}
+
+void StimCircle::setRad(float rad)
+{
+    m_rad = rad;
+}
+void StimCircle::set(float x, float y, float rad, bool on)
+{
+    m_cx = x;
+    m_cy = y;
+    m_rad = rad;
+    m_on = on;
+}
+
+bool StimCircle::isPositionIn(float x, float y) const
+{
+    float dx = x - m_cx;
+    float dy = y - m_cy;
+    return dx*dx + dy*dy <= m_rad*m_rad;
+}
+
+float StimCircle::distanceFromCenter(float x, float y) const
+{
+    float dx = x - m_cx;
+    float dy = y - m_cy;
+    return std::sqrt(dx*dx + dy*dy);
+}
+
+float StimCircle::squaredDistanceFromCenter(float x, float y) const
+{
+    float dx = x - m_cx;
+    float dy = y - m_cy;
+    return dx*dx + dy*dy;
+}
+
+float StimCircle::distanceFromEdge(float x, float y) const
+{
+    return std::abs(distanceFromCenter(x, y) - m_rad);
+}
+
+float StimCircle::getExtent() const
+{
+    return m_rad;
+}
+
+void StimCircle::getBounds(float& xMin, float& yMin, float& xMax, float& yMax) const
+{
+    xMin = m_cx - m_rad;
+    yMin = m_cy - m_rad;
+    xMax = m_cx + m_rad;
+    yMax = m_cy + m_rad;
+}
+
+std::string StimCircle::returnType() const
+{
+    return "circle";
+}
+
+// Rect methods
+
+StimRect::StimRect()
+    : m_w(0), m_h(0), StimArea(0, 0, false)
+{
+}
+
+StimRect::StimRect(float x, float y, float w, float h, bool on) : StimArea(x, y, on)
+{
+    m_w = w;
+    m_h = h;
+}
+
+float StimRect::getW() const
+{
+    return m_w;
+}
+float StimRect::getH() const
+{
+    return m_h;
+}
+
+void StimRect::setW(float w)
+{
+    m_w = w;
+}
+void StimRect::setH(float h)
+{
+    m_h = h;
+}
+void StimRect::set(float x, float y, float w, float h, bool on)
+{
+    m_cx = x;
+    m_cy = y;
+    m_w = w;
+    m_h = h;
+    m_on = on;
+}
+
+bool StimRect::isPositionIn(float x, float y) const
+{
+    if ((std::abs(x - m_cx) < m_w / 2.0) && (std::abs(y - m_cy) < m_h / 2.0))
+        return true;
+    else
+        return false;
+}
+
+float StimRect::distanceFromCenter(float x, float y) const
+{
+    return std::abs(x - m_cx) + std::abs(y - m_cy);
+}
+
+float StimRect::squaredDistanceFromCenter(float x, float y) const
+{
+    float d = distanceFromCenter(x, y);
+    return d*d;
+}
+
+float StimRect::distanceFromEdge(float x, float y) const
+{
+    float dx = std::abs(x - m_cx) - m_w / 2.0f;
+    float dy = std::abs(y - m_cy) - m_h / 2.0f;
+    if (dx <= 0 && dy <= 0)
+        return std::min(-dx, -dy);
+    dx = std::max(dx, 0.0f);
+    dy = std::max(dy, 0.0f);
+    return std::sqrt(dx*dx + dy*dy);
+}
+
+float StimRect::getExtent() const
+{
+    // distanceFromCenter is the L1 distance, which reaches this at the corners
+    return (m_w + m_h) / 2.0f;
+}
+
+void StimRect::getBounds(float& xMin, float& yMin, float& xMax, float& yMax) const
+{
+    xMin = m_cx - m_w / 2.0f;
+    yMin = m_cy - m_h / 2.0f;
+    xMax = m_cx + m_w / 2.0f;
+    yMax = m_cy + m_h / 2.0f;
+}
+
+std::string StimRect::returnType() const
+{
+    return "rect";
+}
+
+// Polygon methods
+
+StimPolygon::StimPolygon()
+    : StimArea(0, 0, false), m_area(0), m_extent(0)
+{
+}
+
+StimPolygon::StimPolygon(const std::vector<float>& xs, const std::vector<float>& ys, bool on)
+    : StimArea(0, 0, on), m_area(0), m_extent(0)
+{
+    set(xs, ys, on);
+}
+
+int StimPolygon::getNumVertices() const
+{
+    return (int) m_xs.size();
+}
+float StimPolygon::getVertexX(int i) const
+{
+    return m_xs[i];
+}
+float StimPolygon::getVertexY(int i) const
+{
+    return m_ys[i];
+}
+float StimPolygon::getArea() const
+{
+    return m_area;
+}
+
+void StimPolygon::set(const std::vector<float>& xs, const std::vector<float>& ys, bool on)
+{
+    size_t n = std::min(xs.size(), ys.size());
+    m_xs.assign(xs.begin(), xs.begin() + n);
+    m_ys.assign(ys.begin(), ys.begin() + n);
+    m_on = on;
+
+    // shoelace area and centroid, falling back to the vertex mean for degenerate outlines
+    double a = 0, cx = 0, cy = 0;
+    for (size_t i = 0, j = n - 1; i < n; j = i++)
+    {
+        double cross = double(m_xs[j]) * m_ys[i] - double(m_xs[i]) * m_ys[j];
+        a += cross;
+        cx += (m_xs[j] + m_xs[i]) * cross;
+        cy += (m_ys[j] + m_ys[i]) * cross;
+    }
+    a /= 2;
+    m_area = float(std::abs(a));
+    // radius of the circle with the same area
+    m_extent = std::sqrt(m_area / pi);
+
+    if (std::abs(a) > 1e-12)
+    {
+        m_cx = float(cx / (6 * a));
+        m_cy = float(cy / (6 * a));
+    }
+    else
+    {
+        m_cx = m_cy = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            m_cx += m_xs[i] / n;
+            m_cy += m_ys[i] / n;
+        }
+    }
+}
+
+bool StimPolygon::isPositionIn(float x, float y) const
+{
+    // even-odd rule
+    bool in = false;
+    size_t n = m_xs.size();
+    for (size_t i = 0, j = n - 1; i < n; j = i++)
+    {
+        if ((m_ys[i] > y) != (m_ys[j] > y)
+            && x < (m_xs[j] - m_xs[i]) * (y - m_ys[i]) / (m_ys[j] - m_ys[i]) + m_xs[i])
+            in = !in;
+    }
+    return in;
+}
+
+float StimPolygon::distanceFromCenter(float x, float y) const
+{
+    float dx = x - m_cx;
+    float dy = y - m_cy;
+    return std::sqrt(dx*dx + dy*dy);
+}
+
+float StimPolygon::squaredDistanceFromCenter(float x, float y) const
+{
+    float dx = x - m_cx;
+    float dy = y - m_cy;
+    return dx*dx + dy*dy;
+}
+
+float StimPolygon::distanceFromEdge(float x, float y) const
+{
+    float d2 = HUGE_VALF;
+    size_t n = m_xs.size();
+    for (size_t i = 0, j = n - 1; i < n; j = i++)
+    {
+        float ex = m_xs[i] - m_xs[j];
+        float ey = m_ys[i] - m_ys[j];
+        float len2 = ex*ex + ey*ey;
+        float t = len2 > 0 ? ((x - m_xs[j])*ex + (y - m_ys[j])*ey) / len2 : 0;
+        t = std::min(std::max(t, 0.0f), 1.0f);
+        float dx = x - (m_xs[j] + t*ex);
+        float dy = y - (m_ys[j] + t*ey);
+        d2 = std::min(d2, dx*dx + dy*dy);
+    }
+    return std::sqrt(d2);
+}
+
+float StimPolygon::getExtent() const
+{
+    return m_extent;
+}
+
+void StimPolygon::getBounds(float& xMin, float& yMin, float& xMax, float& yMax) const
+{
+    xMin = yMin = HUGE_VALF;
+    xMax = yMax = -HUGE_VALF;
+    for (size_t i = 0; i < m_xs.size(); i++)
+    {
+        xMin = std::min(xMin, m_xs[i]);
+        yMin = std::min(yMin, m_ys[i]);
+        xMax = std::max(xMax, m_xs[i]);
+        yMax = std::max(yMax, m_ys[i]);
+    }
+}
+
+std::string StimPolygon::returnType() const
+{
+    return "polygon";
+}
+
+
@@ -0,0 +1,170 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Tracking plugin for the Open Ephys GUI
+    Written by:
+
+    Alessio Buccino     alessiob@ifi.uio.no
+    Mikkel Lepperod
+    Svenn-Arne Dragly
+
+    Center for Integrated Neuroplasticity CINPLA
+    Department of Biosciences
+    University of Oslo
+    Norway
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACKINGSTIMAREAS_H
+#define TRACKINGSTIMAREAS_H
+
+#include <string>
+#include <vector>
+
+/**
+
+  Class for Abstrac Stimulation Area
+
+*/
+class StimArea
+{
+public:
+    StimArea();
+    StimArea(float x, float y, bool on);
+    virtual ~StimArea() {}
+
+    float getX() const;
+    float getY() const;
+    bool getOn() const;
+    void setX(float x);
+    void setY(float y);
+
+    bool on();
+    bool off();
+
+    virtual bool isPositionIn(float x, float y) const = 0;
+    virtual float distanceFromCenter(float x, float y) const = 0;
+    /** distanceFromCenter squared, without the square root. */
+    virtual float squaredDistanceFromCenter(float x, float y) const = 0;
+    /** Distance from (x, y) to the area's outline, inside or out. */
+    virtual float distanceFromEdge(float x, float y) const = 0;
+    /** Distance from the centre at which the gauss mode rate falls to stimSD. */
+    virtual float getExtent() const = 0;
+    virtual void getBounds(float& xMin, float& yMin, float& xMax, float& yMax) const = 0;
+    virtual std::string returnType() const = 0;
+
+protected:
+
+    float m_cx;
+    float m_cy;
+    bool m_on;
+
+};
+/**
+
+  Class for Stimulation Circles
+
+*/
+class StimCircle : public StimArea
+{
+public:
+    StimCircle();
+    StimCircle(float x, float y, float r, bool on);
+
+    float getRad() const;
+
+    void setRad(float rad);
+    void set(float x, float y, float rad, bool on);
+
+    bool isPositionIn(float x, float y) const override;
+    float distanceFromCenter(float x, float y) const override;
+    float squaredDistanceFromCenter(float x, float y) const override;
+    float distanceFromEdge(float x, float y) const override;
+    float getExtent() const override;
+    void getBounds(float& xMin, float& yMin, float& xMax, float& yMax) const override;
+    std::string returnType() const override;
+
+private:
+    float m_rad;
+};
+
+/**
+
+  Class for Stimulation Rectangle
+
+*/
+class StimRect : public StimArea
+{
+public:
+    StimRect();
+    StimRect(float x, float y, float w, float h, bool on);
+
+    float getW() const;
+    float getH() const;
+
+    void setW(float w);
+    void setH(float h);
+    void set(float x, float y, float w, float h, bool on);
+
+    bool isPositionIn(float x, float y) const override;
+    float distanceFromCenter(float x, float y) const override;
+    float squaredDistanceFromCenter(float x, float y) const override;
+    float distanceFromEdge(float x, float y) const override;
+    float getExtent() const override;
+    void getBounds(float& xMin, float& yMin, float& xMax, float& yMax) const override;
+    std::string returnType() const override;
+
+private:
+    float m_w;
+    float m_h;
+};
+
+/**
+
+  Class for Stimulation Polygons, e.g. the arms of a maze.
+  The centre is the polygon's centroid; the outline may be concave but not self-intersecting.
+
+*/
+class StimPolygon : public StimArea
+{
+public:
+    StimPolygon();
+    StimPolygon(const std::vector<float>& xs, const std::vector<float>& ys, bool on);
+
+    int getNumVertices() const;
+    float getVertexX(int i) const;
+    float getVertexY(int i) const;
+    float getArea() const;
+
+    void set(const std::vector<float>& xs, const std::vector<float>& ys, bool on);
+
+    bool isPositionIn(float x, float y) const override;
+    float distanceFromCenter(float x, float y) const override;
+    float squaredDistanceFromCenter(float x, float y) const override;
+    float distanceFromEdge(float x, float y) const override;
+    float getExtent() const override;
+    void getBounds(float& xMin, float& yMin, float& xMax, float& yMax) const override;
+    std::string returnType() const override;
+
+private:
+    std::vector<float> m_xs;
+    std::vector<float> m_ys;
+    float m_area;
+    float m_extent;
+};
+
+#endif // TRACKINGSTIMAREAS_H
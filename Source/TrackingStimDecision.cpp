@@ -0,0 +1,155 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Tracking plugin for the Open Ephys GUI
+    Written by:
+
+    Alessio Buccino     alessiob@ifi.uio.no
+    Mikkel Lepperod
+    Svenn-Arne Dragly
+
+    Center for Integrated Neuroplasticity CINPLA
+    Department of Biosciences
+    University of Oslo
+    Norway
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TrackingStimDecision.h"
+
+#include <algorithm>
+#include <cmath>
+
+TrackingRateTable::TrackingRateTable()
+{
+    build(uniform, 0, 1);
+}
+
+void TrackingRateTable::build(stim_mode mode, float stimFreq, float stimSD)
+{
+    // gauss: stimFreq * exp(-u / k) with k = -1 / log(stimSD), i.e. stimFreq * stimSD^u
+    m_scale = float(RATE_TABLE_SIZE - 1) / RATE_TABLE_RANGE;
+    m_maxRate = 0;
+    for (int i = 0; i < RATE_TABLE_SIZE; i++)
+    {
+        float u = i / m_scale;
+        if (mode != gauss)
+            m_rates[i] = stimFreq;
+        else if (stimSD > 0)
+            m_rates[i] = stimFreq * std::pow(stimSD, u);
+        else
+            m_rates[i] = i == 0 ? stimFreq : 0;
+        m_maxRate = std::max(m_maxRate, m_rates[i]);
+    }
+}
+
+float TrackingRateTable::getMaxRate() const
+{
+    return m_maxRate;
+}
+
+TrackingStimDecision::TrackingStimDecision()
+    : m_ttlTriggered(false)
+    , m_untilNext(-1)
+    , m_candidateRate(0)
+    , m_distribution(0.0, 1.0)
+    , m_interval(1.0)
+{
+}
+
+int TrackingStimDecision::findCircle(const std::vector<StimCircle>& circles, float x, float y)
+{
+    for (int i = 0; i < (int) circles.size(); i++)
+    {
+        if (circles[i].isPositionIn(x, y))
+            return i;
+    }
+    return -1;
+}
+
+float TrackingStimDecision::getStimulationRate(stim_mode mode, float stimFreq, float stimSD,
+                                               const StimArea& area, float x, float y)
+{
+    if (mode != gauss)
+        return stimFreq;
+
+    float dist_norm = area.distanceFromCenter(x, y) / area.getExtent();
+    float k = -1.0 / std::log(stimSD);
+    return stimFreq*std::exp(-pow(dist_norm,2)/k);
+}
+
+int TrackingStimDecision::update(const StimArea* areaIn, stim_mode mode, const TrackingRateTable& rates,
+                                 float x, float y, float timePassed, std::vector<float>& pulseTimes)
+{
+    if (areaIn == nullptr)
+        m_ttlTriggered = false;
+
+    if (mode == ttl)
+    {
+        if (areaIn == nullptr || m_ttlTriggered)
+            return 0;
+        m_ttlTriggered = true;
+        pulseTimes.push_back(0);
+        return 1;
+    }
+
+    float maxRate = rates.getMaxRate();
+    if (!(maxRate > 0))
+    {
+        m_untilNext = -1;
+        return 0;
+    }
+
+    // the candidates form a Poisson process at the highest rate anywhere,
+    // so it runs on outside the regions too and only the acceptance depends on the position
+    if (m_untilNext < 0 || maxRate != m_candidateRate)
+    {
+        m_candidateRate = maxRate;
+        m_untilNext = m_interval(m_generator) / maxRate;
+    }
+
+    float acceptance = 0;
+    if (areaIn != nullptr)
+        acceptance = rates.getRate(*areaIn, x, y) / maxRate;
+
+    int count = 0;
+    while (m_untilNext < timePassed)
+    {
+        if (acceptance >= 1 || (acceptance > 0 && m_distribution(m_generator) < acceptance))
+        {
+            pulseTimes.push_back(float(m_untilNext));
+            count++;
+        }
+        m_untilNext += m_interval(m_generator) / maxRate;
+    }
+    m_untilNext -= timePassed;
+
+    return count;
+}
+
+void TrackingStimDecision::reset()
+{
+    m_ttlTriggered = false;
+}
+
+void TrackingStimDecision::seed(unsigned int seed)
+{
+    m_generator.seed(seed);
+    m_distribution.reset();
+    m_interval.reset();
+    m_untilNext = -1;
+}
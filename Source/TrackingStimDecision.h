@@ -0,0 +1,141 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Tracking plugin for the Open Ephys GUI
+    Written by:
+
+    Alessio Buccino     alessiob@ifi.uio.no
+    Mikkel Lepperod
+    Svenn-Arne Dragly
+
+    Center for Integrated Neuroplasticity CINPLA
+    Department of Biosciences
+    University of Oslo
+    Norway
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACKINGSTIMDECISION_H
+#define TRACKINGSTIMDECISION_H
+
+#include "TrackingStimAreas.h"
+
+#include <random>
+#include <vector>
+
+typedef enum
+{
+  uniform,
+  gauss,
+  ttl
+} stim_mode;
+
+#define RATE_TABLE_SIZE 1024
+#define RATE_TABLE_RANGE 16
+
+/**
+    Pulse rate against the squared distance from a region's centre, normalized by the
+    squared extent, tabulated once per change of mode, stimFreq or stimSD so that the
+    rate at a position needs no exp, log or square root. Distances beyond
+    RATE_TABLE_RANGE get the last entry.
+*/
+class TrackingRateTable
+{
+public:
+    TrackingRateTable();
+
+    void build(stim_mode mode, float stimFreq, float stimSD);
+
+    /** Rate in Hz at normalized squared distance u, interpolated linearly. */
+    float getRate(float u) const
+    {
+        float t = u * m_scale;
+        if (!(t < RATE_TABLE_SIZE - 1))
+            return t >= 0 ? m_rates[RATE_TABLE_SIZE - 1] : m_rates[0];
+        int i = int(t);
+        return m_rates[i] + (t - i) * (m_rates[i + 1] - m_rates[i]);
+    }
+
+    /** Rate in Hz at (x, y) inside area. */
+    float getRate(const StimArea& area, float x, float y) const
+    {
+        float extent = area.getExtent();
+        return getRate(area.squaredDistanceFromCenter(x, y) / (extent * extent));
+    }
+
+    /** Upper bound of the rate anywhere, the candidate rate for thinning. */
+    float getMaxRate() const;
+
+private:
+    float m_rates[RATE_TABLE_SIZE];
+    float m_scale;
+    float m_maxRate;
+};
+
+/**
+    Closed-loop stimulation decision, independent of the processor and of JUCE.
+
+    Called once per processing block with the current position, the region it is in
+    and the time since the previous call, it returns the pulses due in that interval:
+      - uniform: a Poisson process at stimFreq while inside a region
+      - gauss: as uniform, with the rate falling off with the distance from the
+        region's centre (stimSD is the relative rate at the region's extent)
+      - ttl: one pulse on entering a region, re-armed once the position leaves
+
+    The stochastic modes draw exponential intervals between candidate pulses at the
+    rate table's maximum, carried over from one call to the next, and keep each
+    candidate with probability rate / maximum (thinning). Any number of pulses can
+    fall in one call, at their exact times, so the rate is not limited by the block rate.
+*/
+class TrackingStimDecision
+{
+public:
+    TrackingStimDecision();
+
+    /** Index of the first circle containing (x, y), -1 if there is none, by linear scan. */
+    static int findCircle(const std::vector<StimCircle>& circles, float x, float y);
+
+    /** Pulse rate in Hz at (x, y) inside area, computed exactly. */
+    static float getStimulationRate(stim_mode mode, float stimFreq, float stimSD,
+                                    const StimArea& area, float x, float y);
+
+    /**
+        Appends to pulseTimes the pulses due for (x, y) in the timePassed seconds since the
+        last call, in seconds from the start of that interval, and returns how many there are.
+        areaIn is the region containing (x, y), as found by findCircle or a TrackingRegionMask,
+        nullptr if there is none. rates must have been built for mode.
+    */
+    int update(const StimArea* areaIn, stim_mode mode, const TrackingRateTable& rates,
+               float x, float y, float timePassed, std::vector<float>& pulseTimes);
+
+    /** Re-arms the ttl mode. */
+    void reset();
+
+    /** Restarts the random sequence, so that the same positions and times give the same pulses. */
+    void seed(unsigned int seed);
+
+private:
+    bool m_ttlTriggered;
+    // time from the start of the next interval to the next candidate pulse, < 0 to draw a new one
+    double m_untilNext;
+    float m_candidateRate;
+    std::default_random_engine m_generator;
+    std::uniform_real_distribution<float> m_distribution;
+    std::exponential_distribution<double> m_interval;
+};
+
+#endif // TRACKINGSTIMDECISION_H
@@ -44,21 +44,28 @@ TrackingStimulator::TrackingStimulator()
     , m_simulateTrajectory(false)
     , m_selectedCircle(-1)
     , m_timePassed(0.0)
-    , m_currentTime(0.0)
-    , m_previousTime(0.0)
+    , m_currentTime(0)
+    , m_previousTime(-1)
     , m_timePassed_sim(0.0)
-    , m_currentTime_sim(0.0)
-    , m_previousTime_sim(0.0)
+    , m_currentTime_sim(0)
+    , m_previousTime_sim(0)
     , m_count(0)
     , m_forward(true)
     , m_rad(0.0)
     , m_outputChan(0)
     , m_pulseDuration(DEF_DUR)
-    , m_ttlTriggered(false)
+    , m_interPulse(DEF_INTER_PULSE)
+    , m_repetitions(DEF_REPETITIONS)
+    , m_pulseChan(0)
+    , m_previousBlockStart(0)
+    , m_droppedTrains(0)
     , m_stimFreq(DEF_FREQ)
     , m_stimSD(DEF_SD)
     , m_stimMode(uniform)
+    , m_predictor(no_prediction)
+    , m_predictionLatency(DEF_LATENCY)
 {
+    m_rateTable.build(m_stimMode, m_stimFreq, m_stimSD);
 
     setProcessorType (PROCESSOR_TYPE_FILTER);
 
@@ -88,10 +95,10 @@ void TrackingStimulator::createEventChannels()
 
 // Setters - Getters
 
-TrackingSources& TrackingStimulator::getTrackingSource(int s) const
+TrackingSources& TrackingStimulator::getTrackingSource(int s)
 {
-    if (s < sources.size())
-        return sources.getReference (s);
+    jassert (s >= 0 && s < sources.size());
+    return sources[s];
 }
 
 float TrackingStimulator::getX(int s) const
@@ -135,6 +142,22 @@ float TrackingStimulator::getHeight(int s) const
         return -1;
 }
 
+float TrackingStimulator::getSpeed(int s) const
+{
+    if (s >= 0 && s < sources.size())
+        return sources[s].motion.speed;
+    else
+        return -1;
+}
+
+float TrackingStimulator::getHeading(int s) const
+{
+    if (s >= 0 && s < sources.size())
+        return sources[s].motion.heading;
+    else
+        return 0;
+}
+
 bool TrackingStimulator::getSimulateTrajectory() const
 {
     return m_simulateTrajectory;
@@ -147,29 +170,104 @@ void TrackingStimulator::setSimulateTrajectory(bool sim)
 
 std::vector<StimCircle> TrackingStimulator::getCircles()
 {
+    const ScopedLock sl(lock);
     return m_circles;
 }
 
 void TrackingStimulator::addCircle(StimCircle c)
 {
+    const ScopedLock sl(lock);
     m_circles.push_back(c);
+    updateRegionMask();
 }
 
 void TrackingStimulator::editCircle(int ind, float x, float y, float rad, bool on)
 {
+    const ScopedLock sl(lock);
     m_circles[ind].set(x,y,rad,on);
+    updateRegionMask();
 }
 
 void TrackingStimulator::deleteCircle(int ind)
 {
+    const ScopedLock sl(lock);
     if (m_circles.size())
         m_circles.erase(m_circles.begin() + ind);
+    updateRegionMask();
 }
 
 void TrackingStimulator::disableCircles()
 {
+    const ScopedLock sl(lock);
     for(int i=0; i<m_circles.size(); i++)
         m_circles[i].off();
+    updateRegionMask();
+}
+
+std::vector<StimPolygon> TrackingStimulator::getPolygons()
+{
+    const ScopedLock sl(lock);
+    return m_polygons;
+}
+
+void TrackingStimulator::addPolygon(StimPolygon p)
+{
+    const ScopedLock sl(lock);
+    m_polygons.push_back(p);
+    updateRegionMask();
+}
+
+void TrackingStimulator::deletePolygon(int ind)
+{
+    const ScopedLock sl(lock);
+    if (ind >= 0 && ind < m_polygons.size())
+        m_polygons.erase(m_polygons.begin() + ind);
+    updateRegionMask();
+}
+
+int TrackingStimulator::getNRegions() const
+{
+    const ScopedLock sl(lock);
+    return int(m_circles.size() + m_polygons.size());
+}
+
+bool TrackingStimulator::getRegionOn(int ind) const
+{
+    const ScopedLock sl(lock);
+    if (ind < 0 || ind >= getNRegions())
+        return false;
+    return getRegion(ind).getOn();
+}
+
+int TrackingStimulator::getMaskResolution() const
+{
+    return m_regionMask.getResolution();
+}
+
+void TrackingStimulator::setMaskResolution(int cells)
+{
+    const ScopedLock sl(lock);
+    m_regionMask.setResolution(cells);
+    updateRegionMask();
+}
+
+const StimArea& TrackingStimulator::getRegion(int ind) const
+{
+    // circles first, then polygons, as in the region mask
+    if (ind < m_circles.size())
+        return m_circles[ind];
+    return m_polygons[ind - m_circles.size()];
+}
+
+void TrackingStimulator::updateRegionMask()
+{
+    const ScopedLock sl(lock);
+    std::vector<const StimArea*> regions;
+    for (const StimCircle& circle : m_circles)
+        regions.push_back(&circle);
+    for (const StimPolygon& polygon : m_polygons)
+        regions.push_back(&polygon);
+    m_regionMask.build(regions);
 }
 
 int TrackingStimulator::getSelectedCircle() const
@@ -208,6 +306,24 @@ int TrackingStimulator::getTtlDuration() const
 {
     return m_pulseDuration;
 }
+int TrackingStimulator::getInterPulse() const
+{
+    return m_interPulse;
+}
+int TrackingStimulator::getRepetitions() const
+{
+    return m_repetitions;
+}
+
+prediction_model TrackingStimulator::getPredictionModel() const
+{
+    return m_predictor.getModel();
+}
+
+float TrackingStimulator::getPredictionLatency() const
+{
+    return m_predictionLatency;
+}
 
 void TrackingStimulator::setOutputChan(int chan)
 {
@@ -217,53 +333,94 @@ void TrackingStimulator::setOutputChan(int chan)
 void TrackingStimulator::setSelectedSource(int source)
 {
     m_selectedSource = source;
+    m_predictor.reset();
 }
 
 void TrackingStimulator::setStimFreq(float stimFreq)
 {
     m_stimFreq = stimFreq;
+    updateRateTable();
 }
 void TrackingStimulator::setStimSD(float stimSD)
 {
     m_stimSD = stimSD;
+    updateRateTable();
 }
 void TrackingStimulator::setTtlDuration(int dur)
 {
     m_pulseDuration = dur;
+    updatePulseTrain();
+}
+void TrackingStimulator::setInterPulse(int interval)
+{
+    m_interPulse = interval;
+    updatePulseTrain();
+}
+void TrackingStimulator::setRepetitions(int pulses)
+{
+    m_repetitions = pulses;
+    updatePulseTrain();
+}
+
+void TrackingStimulator::updatePulseTrain()
+{
+    const ScopedLock sl(lock);
+    double fs = getSampleRate();
+    m_pulses.setTrain(int64(ceil(m_pulseDuration / 1000.0 * fs)),
+                      int64(ceil((m_pulseDuration + m_interPulse) / 1000.0 * fs)),
+                      m_repetitions);
+}
+
+void TrackingStimulator::setPredictionModel(prediction_model model)
+{
+    m_predictor.setModel(model);
+}
+
+void TrackingStimulator::setPredictionLatency(float latency)
+{
+    m_predictionLatency = latency;
+    m_predictor.reset();
 }
 
 
 void TrackingStimulator::setStimMode(stim_mode mode)
 {
     m_stimMode = mode;
+    updateRateTable();
+}
+
+const TrackingRateTable& TrackingStimulator::getRateTable() const
+{
+    return m_rateTable;
+}
+
+void TrackingStimulator::updateRateTable()
+{
+    const ScopedLock sl(lock);
+    m_rateTable.build(m_stimMode, m_stimFreq, m_stimSD);
 }
 
 void TrackingStimulator::updateSettings()
 {
     sources.clear();
-    TrackingSources s;
+    m_predictor.reset();
     int nEvents = getTotalEventChannels();
 
     for (int i = 0; i < nEvents; i++)
     {
         const EventChannel* event = getEventChannel(i);
         if (event->getName().compare("Tracking data") == 0)
-        {
-            s.eventIndex = event->getSourceIndex();
-            s.sourceId =  event->getSourceNodeID();
-            s.name = "Tracking source " + String(event->getSourceIndex()+1);
-            s.color = String("None");
-            s.x_pos = -1;
-            s.y_pos = -1;
-            s.width = -1;
-            s.height = -1;
-            sources.add (s);
-        }
+            sources.add (event->getSourceNodeID(), event->getSourceIndex());
+        // a source's kinematics channel follows its data channel
+        else if (event->getName().compare("Tracking kinematics") == 0 && sources.size() > 0
+                 && sources[sources.size() - 1].sourceId == event->getSourceNodeID())
+            sources.addAlias (event->getSourceNodeID(), event->getSourceIndex(), sources.size() - 1);
     }
+    updatePulseTrain();
 }
 
 
-void TrackingStimulator::process(AudioSampleBuffer&)
+void TrackingStimulator::process(AudioSampleBuffer& buffer)
 {
     if (!m_simulateTrajectory)
     {
@@ -271,9 +428,11 @@ void TrackingStimulator::process(AudioSampleBuffer&)
     }
     else
     {
-        // simulate events at 60Hz
-        m_currentTime_sim = Time::currentTimeMillis();
-        m_timePassed_sim = float(m_currentTime_sim - m_previousTime_sim)/1000.0; // in seconds
+        // simulate events at TRACKING_FREQ of sample time
+        m_currentTime_sim = CoreServices::getGlobalTimestamp();
+        if (m_currentTime_sim < m_previousTime_sim) // acquisition restarted
+            m_previousTime_sim = m_currentTime_sim;
+        m_timePassed_sim = float(double(m_currentTime_sim - m_previousTime_sim) / getSampleRate()); // in seconds
 
         if (m_timePassed_sim >= float(1.0/TRACKING_FREQ))
         {
@@ -299,91 +458,110 @@ void TrackingStimulator::process(AudioSampleBuffer&)
             m_width = 1;
             m_height = 1;
 
-            m_previousTime_sim = Time::currentTimeMillis();
+            m_previousTime_sim = m_currentTime_sim;
             m_timePassed_sim = 0;
             m_count++;
             m_positionIsUpdated = true;
         }
     }
 
+    int64 blockStart = CoreServices::getGlobalTimestamp();
+    if (blockStart < m_previousBlockStart)
+        restartPulses(blockStart);
+    m_previousBlockStart = blockStart;
+
     if (m_isOn)
     {
 
-        m_currentTime = Time::currentTimeMillis();
-        m_timePassed = float(m_currentTime - m_previousTime) / 1000.f; // in seconds
+        // time since the previous block, counted in samples so that callback jitter does not
+        // change the stimulation probability and replaying a recording gives the same pulses
+        m_currentTime = blockStart;
+        if (m_previousTime < 0 || m_currentTime < m_previousTime) // first block or acquisition restarted
+            m_previousTime = m_currentTime;
+        m_timePassed = float(double(m_currentTime - m_previousTime) / getSampleRate()); // in seconds
 
         lock.enter();
 
-        // Check if current position is within stimulation areas
-        bool stim = stimulate();
+        // decide on where the animal is at this block rather than where it was in the last frame
+        float x = m_x;
+        float y = m_y;
+        if (!m_simulateTrajectory && m_predictor.getModel() != no_prediction)
+            m_predictor.predict(double(blockStart) / getSampleRate(), x, y);
+
+        // the trains due in the elapsed interval start at the same offsets from this block
+        int regionIn = m_regionMask.find(x, y);
+        m_pulseTimes.clear();
+        m_decision.update(regionIn == -1 ? nullptr : &getRegion(regionIn), m_stimMode, m_rateTable,
+                          x, y, m_timePassed, m_pulseTimes);
+        for (float pulseTime : m_pulseTimes)
+            if (! m_pulses.trigger(blockStart + int64(pulseTime * getSampleRate())))
+                m_droppedTrains++;
 
-        if (stim)
-        {
-            // Check if timePassed >= latency
-            if (m_stimMode == ttl)
-            {
-                if (!m_ttlTriggered)
-                {
-                    triggerEvent();
-                    m_ttlTriggered = true;
-                }
-            }
-            else
-            {
-                float stim_interval;
-                if (m_stimMode == uniform)  {
-                    stim_interval = float(1.f / m_stimFreq);
-                }
-                else if (m_stimMode == gauss)                     //gaussian
-                {
-                    int circleIn = isPositionWithinCircles(m_x, m_y);
-                    float dist_norm = m_circles[circleIn].distanceFromCenter(m_x, m_y) / m_circles[circleIn].getRad();
-                    float k = -1.0 / std::log(m_stimSD);
-                    float freq_gauss = m_stimFreq*std::exp(-pow(dist_norm,2)/k);
-                    stim_interval = float(1/freq_gauss);
-                }
+        m_previousTime = m_currentTime;
 
-                float stimulationProbability = m_timePassed / stim_interval;
-                std::uniform_real_distribution<float> distribution(0.0, 1.0);
-                float randomNumber = distribution(generator);
+        lock.exit();
+    }
 
-                if (stimulationProbability > 1)
-                    std::cout << "WARNING: The tracking stimulation frequency is higher than the sampling frequency." << std::endl;
+    // trains run to their end even if the stimulation is stopped meanwhile
+    int nSamples = getNumInputs() > 0 ? getNumSamples(0) : buffer.getNumSamples();
+    sendPulseEdges(blockStart, nSamples);
+}
 
-                if (randomNumber < stimulationProbability)
-                {
-                    triggerEvent();
-                }
-            }
+void TrackingStimulator::sendPulseEdges(int64 blockStart, int nSamples)
+{
+    const ScopedLock sl(lock);
+    bool first = true;
+    TrackingPulseEdge edge;
 
+    while (m_pulses.nextEdge(blockStart + nSamples, edge))
+    {
+        if (first)
+        {
+            setTimestampAndSamples(blockStart, 0);
+            first = false;
         }
-        else
-            m_ttlTriggered = false;
-        m_previousTime = m_currentTime;
+        addPulseEdge(blockStart, edge);
+    }
+}
 
-        lock.exit();
+void TrackingStimulator::restartPulses(int64 blockStart)
+{
+    // acquisition restarted: the queued edges belong to the previous timeline,
+    // and a pulse left high is closed at the start of the new one
+    const ScopedLock sl(lock);
+    if (m_pulses.isOn())
+    {
+        setTimestampAndSamples(blockStart, 0);
+        addPulseEdge(blockStart, { blockStart, false });
     }
+    m_pulses.clear();
 }
 
-void TrackingStimulator::triggerEvent()
+void TrackingStimulator::addPulseEdge(int64 blockStart, const TrackingPulseEdge& edge)
 {
-    int64 timestamp = CoreServices::getGlobalTimestamp();
-    setTimestampAndSamples(timestamp, 0);
-    uint8 ttlData = 1 << m_outputChan;
     const EventChannel* chan = getEventChannel(getEventChannelIndex(0, getNodeId()));
 
-    // Send ON event
-    TTLEventPtr event = TTLEvent::createTTLEvent(chan, timestamp, &ttlData, sizeof(uint8), m_outputChan);
-    addEvent(chan, event, 0);
+    // a pulse ends on the line it started on, even if the output changed meanwhile
+    if (edge.on)
+        m_pulseChan = m_outputChan;
+    uint8 ttlData = edge.on ? 1 << m_pulseChan : 0;
+    int sampleOffset = int(jmax(int64(0), edge.sample - blockStart));
 
-    int eventDurationSamp = static_cast<int>(ceil(m_pulseDuration / 1000.0f * getSampleRate()));
-    uint8 ttlDataOff = 0;
-    TTLEventPtr eventOff = TTLEvent::createTTLEvent(chan, timestamp + eventDurationSamp, &ttlDataOff, sizeof(uint8), m_outputChan);
-    addEvent(chan, eventOff, 0);
+    TTLEventPtr event = TTLEvent::createTTLEvent(chan, edge.sample, &ttlData, sizeof(uint8), m_pulseChan);
+    addEvent(chan, event, sampleOffset);
 }
 
 void TrackingStimulator::handleEvent (const EventChannel* eventInfo, const MidiMessage& event, int)
 {
+    if (eventInfo->getName().compare("Tracking kinematics") == 0)
+    {
+        BinaryEventPtr evtptr = BinaryEvent::deserializeFromMessage(event, eventInfo);
+        int sourceIndex = sources.indexOf (evtptr->getSourceID(), evtptr->getSourceIndex());
+        if (sourceIndex >= 0)
+            sources[sourceIndex].motion = *reinterpret_cast<const TrackingMotion *>(evtptr->getBinaryDataPointer());
+        return;
+    }
+
     if ((eventInfo->getName()).compare("Tracking data") != 0)
     {
         return;
@@ -395,40 +573,44 @@ void TrackingStimulator::handleEvent (const EventChannel* eventInfo, const MidiM
     int evtId = evtptr->getSourceIndex();
     const auto *position = reinterpret_cast<const TrackingPosition *>(evtptr->getBinaryDataPointer());
 
-    int nSources = sources.size ();
+    int sourceIndex = sources.indexOf (nodeId, evtId);
+    if (sourceIndex < 0)
+        return;
 
-    for (int i = 0; i < nSources; i++)
+    TrackingSources& currentSource = sources[sourceIndex];
+    if (TrackingValidator::hasPosition(*position))
     {
-        TrackingSources& currentSource = sources.getReference (i);
-        if (currentSource.sourceId == nodeId && evtId == currentSource.eventIndex)
-        {
-            if(!(position->x != position->x || position->y != position->y) && position->x != 0 && position->y != 0)
-            {
-                currentSource.x_pos = position->x;
-                currentSource.y_pos = position->y;
-            }
-            if(!(position->width != position->width || position->height != position->height))
-            {
-                currentSource.width = position->width;
-                currentSource.height = position->height;
-            }
+        currentSource.x_pos = position->x;
+        currentSource.y_pos = position->y;
+    }
+    if(!(position->width != position->width || position->height != position->height))
+    {
+        currentSource.width = position->width;
+        currentSource.height = position->height;
+    }
 
-            String sourceColor;
-            evtptr->getMetaDataValue(0)->getValue(sourceColor);
+    String sourceColor;
+    evtptr->getMetaDataValue(0)->getValue(sourceColor);
 
-            if (currentSource.color.compare(sourceColor) != 0)
-            {
-                currentSource.color = sourceColor;
+    if (currentSource.color.compare(sourceColor) != 0)
+    {
+        currentSource.color = sourceColor;
+    }
 
-            }
-        }
+    // dropouts carry no position: the predictor coasts on its last fix
+    if (sourceIndex == m_selectedSource && TrackingValidator::hasPosition(*position))
+    {
+        // the frame was taken m_predictionLatency before the event was stamped
+        double frameTime = double(evtptr->getTimestamp()) / getSampleRate() - m_predictionLatency / 1000.0;
+        m_predictor.update(frameTime, currentSource.x_pos, currentSource.y_pos);
     }
-    if (m_selectedSource != -1)
+
+    if (m_selectedSource >= 0 && m_selectedSource < sources.size())
     {
-        m_x = sources.getReference (m_selectedSource).x_pos;
-        m_y = sources.getReference (m_selectedSource).y_pos;
-        m_width = sources.getReference (m_selectedSource).width;
-        m_height = sources.getReference (m_selectedSource).height;
+        m_x = sources[m_selectedSource].x_pos;
+        m_y = sources[m_selectedSource].y_pos;
+        m_width = sources[m_selectedSource].width;
+        m_height = sources[m_selectedSource].height;
         m_aspect_ratio = m_width / m_height;
     }
     else
@@ -443,23 +625,15 @@ void TrackingStimulator::handleEvent (const EventChannel* eventInfo, const MidiM
 
 int TrackingStimulator::isPositionWithinCircles(float x, float y)
 {
-    int whichCircle = -1;
-    for (int i = 0; i < m_circles.size() && whichCircle == -1; i++)
-    {
-        if (m_circles[i].isPositionIn(x,y))
-            whichCircle = i;
-    }
-    return whichCircle;
+    // circles come first, so a position in a polygon is in no circle
+    int regionIn = isPositionWithinRegions(x, y);
+    return regionIn < (int) m_circles.size() ? regionIn : -1;
 }
 
-bool TrackingStimulator::stimulate()
+int TrackingStimulator::isPositionWithinRegions(float x, float y)
 {
-    if (isPositionWithinCircles(m_x, m_y) != -1)
-    {
-        return true;
-    }
-    else
-        return false;
+    const ScopedLock sl(lock);
+    return m_regionMask.find(x, y);
 }
 
 bool TrackingStimulator::positionDisplayedIsUpdated() const
@@ -491,13 +665,25 @@ void TrackingStimulator::setColorIsUpdated(bool up)
 
 void TrackingStimulator::startStimulation()
 {
+    const ScopedLock sl(lock);
+    m_previousTime = -1;
+    m_decision.seed(DEF_SEED);
+    updatePulseTrain();
+    m_decision.reset();
+    // the scheduler takes at most MAX_QUEUED_TRAINS trains, so a block never needs more starts
+    m_pulseTimes.reserve(MAX_QUEUED_TRAINS);
+    m_droppedTrains = 0;
     m_isOn = true;
-
 }
 
 void TrackingStimulator::stopStimulation()
 {
     m_isOn = false;
+
+    const ScopedLock sl(lock);
+    if (m_droppedTrains > 0)
+        std::cout << "Tracking Stimulator: dropped " << m_droppedTrains << " pulse trains (at most "
+                  << MAX_QUEUED_TRAINS << " in flight)" << std::endl;
 }
 
 bool TrackingStimulator::saveParametersXml()
@@ -518,6 +704,23 @@ bool TrackingStimulator::saveParametersXml()
 
         circles->addChildElement(circ);
     }
+    // save polygons
+    XmlElement* polygons = new XmlElement("POLYGONS");
+    for (int i=0; i<m_polygons.size(); i++)
+    {
+        XmlElement* poly = new XmlElement(String("Polygons_")+=String(i));
+        poly->setAttribute("id", i);
+        poly->setAttribute("on", m_polygons[i].getOn());
+        for (int v=0; v<m_polygons[i].getNumVertices(); v++)
+        {
+            XmlElement* vertex = new XmlElement("VERTEX");
+            vertex->setAttribute("xpos", m_polygons[i].getVertexX(v));
+            vertex->setAttribute("ypos", m_polygons[i].getVertexY(v));
+            poly->addChildElement(vertex);
+        }
+
+        polygons->addChildElement(poly);
+    }
     // save stimulator conf
     XmlElement* stim = new XmlElement("STIMULATION");
 
@@ -525,8 +728,14 @@ bool TrackingStimulator::saveParametersXml()
     stim->setAttribute("sd", m_stimSD);
     stim->setAttribute("stim-mode", m_stimMode);
     stim->setAttribute("duration", m_pulseDuration);
+    stim->setAttribute("inter-pulse", m_interPulse);
+    stim->setAttribute("repetitions", m_repetitions);
+    stim->setAttribute("prediction", m_predictor.getModel());
+    stim->setAttribute("prediction-latency", m_predictionLatency);
+    stim->setAttribute("mask-resolution", m_regionMask.getResolution());
 
     state->addChildElement(circles);
+    state->addChildElement(polygons);
     state->addChildElement(stim);
 
     if (! state->writeToFile(currentConfigFile, String::empty))
@@ -556,7 +765,8 @@ bool TrackingStimulator::loadParametersXml(File fileToLoad)
         {
             if (element->hasTagName("CIRCLES"))
             {
-                m_circles.clear();
+                // parse outside the lock, then swap so process() never sees a partial list
+                std::vector<StimCircle> circles;
                 forEachXmlChildElement(*element, element2)
                 {
                     int id = element2->getIntAttribute("id");
@@ -566,16 +776,46 @@ bool TrackingStimulator::loadParametersXml(File fileToLoad)
                     bool on = element2->getIntAttribute("on");
 
                     StimCircle newCircle = StimCircle((float) cx, (float) cy, (float) crad, on);
-                    m_circles.push_back(newCircle);
+                    circles.push_back(newCircle);
+
+                }
+                const ScopedLock sl(lock);
+                m_circles.swap(circles);
+                updateRegionMask();
+            }
+            if (element->hasTagName("POLYGONS"))
+            {
+                std::vector<StimPolygon> polygons;
+                forEachXmlChildElement(*element, element2)
+                {
+                    bool on = element2->getIntAttribute("on");
+                    std::vector<float> xs, ys;
+                    forEachXmlChildElementWithTagName(*element2, vertex, "VERTEX")
+                    {
+                        xs.push_back((float) vertex->getDoubleAttribute("xpos"));
+                        ys.push_back((float) vertex->getDoubleAttribute("ypos"));
+                    }
 
+                    if (xs.size() >= 3)
+                        polygons.push_back(StimPolygon(xs, ys, on));
                 }
+                const ScopedLock sl(lock);
+                m_polygons.swap(polygons);
+                updateRegionMask();
             }
             if (element->hasTagName("STIMULATION"))
             {
                 m_stimFreq = element->getDoubleAttribute("freq");
                 m_stimSD = element->getDoubleAttribute("sd");
                 m_stimMode = (stim_mode) element->getIntAttribute("stim-mode");
+                updateRateTable();
                 m_pulseDuration = element->getIntAttribute("duration");
+                m_interPulse = element->getIntAttribute("inter-pulse", DEF_INTER_PULSE);
+                m_repetitions = element->getIntAttribute("repetitions", DEF_REPETITIONS);
+                updatePulseTrain();
+                m_predictor.setModel((prediction_model) element->getIntAttribute("prediction", no_prediction));
+                m_predictionLatency = element->getDoubleAttribute("prediction-latency", DEF_LATENCY);
+                setMaskResolution(element->getIntAttribute("mask-resolution", DEF_MASK_RESOLUTION));
             }
         }
         return true;
@@ -664,6 +904,23 @@ void TrackingStimulator::saveCustomParametersToXml(XmlElement *parentElement)
 
         circles->addChildElement(circ);
     }
+    // save polygons
+    XmlElement* polygons = new XmlElement("POLYGONS");
+    for (int i=0; i<m_polygons.size(); i++)
+    {
+        XmlElement* poly = new XmlElement(String("Polygons_")+=String(i));
+        poly->setAttribute("id", i);
+        poly->setAttribute("on", m_polygons[i].getOn());
+        for (int v=0; v<m_polygons[i].getNumVertices(); v++)
+        {
+            XmlElement* vertex = new XmlElement("VERTEX");
+            vertex->setAttribute("xpos", m_polygons[i].getVertexX(v));
+            vertex->setAttribute("ypos", m_polygons[i].getVertexY(v));
+            poly->addChildElement(vertex);
+        }
+
+        polygons->addChildElement(poly);
+    }
     // save stimulator conf
     XmlElement* stim = new XmlElement("STIMULATION");
 
@@ -671,8 +928,14 @@ void TrackingStimulator::saveCustomParametersToXml(XmlElement *parentElement)
     stim->setAttribute("sd", m_stimSD);
     stim->setAttribute("stim-mode", m_stimMode);
     stim->setAttribute("duration", m_pulseDuration);
+    stim->setAttribute("inter-pulse", m_interPulse);
+    stim->setAttribute("repetitions", m_repetitions);
+    stim->setAttribute("prediction", m_predictor.getModel());
+    stim->setAttribute("prediction-latency", m_predictionLatency);
+    stim->setAttribute("mask-resolution", m_regionMask.getResolution());
 
     state->addChildElement(circles);
+    state->addChildElement(polygons);
     state->addChildElement(stim);
 }
 
@@ -690,7 +953,8 @@ void TrackingStimulator::loadCustomParametersFromXml()
                 {
                     if (element->hasTagName("CIRCLES"))
                     {
-                        m_circles.clear();
+                        // parse outside the lock, then swap so process() never sees a partial list
+                        std::vector<StimCircle> circles;
                         forEachXmlChildElement(*element, element2)
                         {
                             int id = element2->getIntAttribute("id");
@@ -700,174 +964,49 @@ void TrackingStimulator::loadCustomParametersFromXml()
                             bool on = element2->getIntAttribute("on");
 
                             StimCircle newCircle = StimCircle((float) cx, (float) cy, (float) crad, on);
-                            m_circles.push_back(newCircle);
+                            circles.push_back(newCircle);
 
                         }
+                        const ScopedLock sl(lock);
+                        m_circles.swap(circles);
+                        updateRegionMask();
+                    }
+                    if (element->hasTagName("POLYGONS"))
+                    {
+                        std::vector<StimPolygon> polygons;
+                        forEachXmlChildElement(*element, element2)
+                        {
+                            bool on = element2->getIntAttribute("on");
+                            std::vector<float> xs, ys;
+                            forEachXmlChildElementWithTagName(*element2, vertex, "VERTEX")
+                            {
+                                xs.push_back((float) vertex->getDoubleAttribute("xpos"));
+                                ys.push_back((float) vertex->getDoubleAttribute("ypos"));
+                            }
+
+                            if (xs.size() >= 3)
+                                polygons.push_back(StimPolygon(xs, ys, on));
+                        }
+                        const ScopedLock sl(lock);
+                        m_polygons.swap(polygons);
+                        updateRegionMask();
                     }
                     if (element->hasTagName("STIMULATION"))
                     {
                         m_stimFreq = element->getDoubleAttribute("freq");
                         m_stimSD = element->getDoubleAttribute("sd");
                         m_stimMode = (stim_mode) element->getIntAttribute("stim-mode");
+                        updateRateTable();
                         m_pulseDuration = element->getIntAttribute("duration");
+                        m_interPulse = element->getIntAttribute("inter-pulse", DEF_INTER_PULSE);
+                        m_repetitions = element->getIntAttribute("repetitions", DEF_REPETITIONS);
+                        updatePulseTrain();
+                        m_predictor.setModel((prediction_model) element->getIntAttribute("prediction", no_prediction));
+                        m_predictionLatency = element->getDoubleAttribute("prediction-latency", DEF_LATENCY);
+                        setMaskResolution(element->getIntAttribute("mask-resolution", DEF_MASK_RESOLUTION));
                     }
                 }
             }
         }
     }
 }
-
-// StimArea methods
-
-
-StimArea::StimArea() :
-    m_cx(0),
-    m_cy(0),
-    m_on(false)
-{
-}
-
-StimArea::StimArea(float x, float y, bool on) :
-    m_cx(x),
-    m_cy(y),
-    m_on(on)
-{
-}
-
-float StimArea::getX()
-{
-    return m_cx;
-}
-float StimArea::getY()
-{
-    return m_cy;
-}
-bool StimArea::getOn()
-{
-    return m_on;
-}
-
-void StimArea::setX(float x)
-{
-    m_cx = x;
-}
-void StimArea::setY(float y)
-{
-    m_cy = y;
-}
-
-bool StimArea::on()
-{
-    m_on = true;
-    return m_on;
-}
-bool StimArea::off()
-{
-    m_on = false;
-    return m_on;
-}
-
-// Circle methods
-
-StimCircle::StimCircle()
-    : m_rad(0), StimArea(0, 0, false)
-{
-}
-
-StimCircle::StimCircle(float x, float y, float rad, bool on) : StimArea(x, y, on)
-{
-    m_rad = rad;
-}
-
-float StimCircle::getRad()
-{
-    return m_rad;
-}
-
-void StimCircle::setRad(float rad)
-{
-    m_rad = rad;
-}
-void StimCircle::set(float x, float y, float rad, bool on)
-{
-    m_cx = x;
-    m_cy = y;
-    m_rad = rad;
-    m_on = on;
-}
-
-bool StimCircle::isPositionIn(float x, float y)
-{
-    if (pow(x - m_cx,2) + pow(y - m_cy,2)
-            <= m_rad*m_rad)
-        return true;
-    else
-        return false;
-}
-
-float StimCircle::distanceFromCenter(float x, float y){
-    return sqrt(pow(x - m_cx,2) + pow(y - m_cy,2));
-}
-
-String StimCircle::returnType()
-{
-    return String("circle");
-}
-
-// Rect methods
-
-StimRect::StimRect()
-    : m_w(0), m_h(0), StimArea(0, 0, false)
-{
-}
-
-StimRect::StimRect(float x, float y, float w, float h, bool on) : StimArea(x, y, on)
-{
-    m_w = w;
-    m_h = h;
-}
-
-float StimRect::getW()
-{
-    return m_w;
-}
-float StimRect::getH()
-{
-    return m_h;
-}
-
-void StimRect::setW(float w)
-{
-    m_w = w;
-}
-void StimRect::setH(float h)
-{
-    m_h = h;
-}
-void StimRect::set(float x, float y, float w, float h, bool on)
-{
-    m_cx = x;
-    m_cy = y;
-    m_w = w;
-    m_h = h;
-    m_on = on;
-}
-
-bool StimRect::isPositionIn(float x, float y)
-{
-    if ((std::abs(x - m_cx) < m_w / 2.0) && (std::abs(y - m_cy) < m_h / 2.0))
-        return true;
-    else
-        return false;
-}
-
-float StimRect::distanceFromCenter(float x, float y){
-    return std::abs(x - m_cx) + std::abs(y - m_cy);
-}
-
-String StimRect::returnType()
-{
-    return String("rect");
-}
-
-
@@ -35,9 +35,13 @@
 #include <ProcessorHeaders.h>
 #include "TrackingStimulatorEditor.h"
 #include "TrackingMessage.h"
+#include "TrackingStimAreas.h"
+#include "TrackingStimDecision.h"
+#include "TrackingPredictor.h"
+#include "TrackingRegionMask.h"
+#include "TrackingPulseScheduler.h"
 
 #include <vector>
-#include <random>
 
 #define DEF_PHASE_DURATION 1
 #define DEF_INTER_PHASE 1
@@ -48,100 +52,13 @@
 #define DEF_FREQ 2
 #define DEF_SD 0.5
 #define DEF_DUR 2
+#define DEF_LATENCY 40
+#define DEF_SEED 1
 
 #define TRACKING_FREQ 20
 
 #define MAX_CIRCLES 9
 
-/**
-
-  Class for Abstrac Stimulation Area
-
-*/
-class StimArea
-{
-public:
-    StimArea();
-    StimArea(float x, float y, bool on);
-
-    float getX();
-    float getY();
-    bool getOn();
-    void setX(float x);
-    void setY(float y);
-
-    bool on();
-    bool off();
-
-    virtual bool isPositionIn(float x, float y) = 0;
-    virtual float distanceFromCenter(float x, float y) = 0;
-    virtual String returnType() = 0;
-
-protected:
-
-    float m_cx;
-    float m_cy;
-    bool m_on;
-
-};
-/**
-
-  Class for Stimulation Circles
-
-*/
-class StimCircle : public StimArea
-{
-public:
-    StimCircle();
-    StimCircle(float x, float y, float r, bool on);
-
-    float getRad();
-
-    void setRad(float rad);
-    void set(float x, float y, float rad, bool on);
-
-    bool isPositionIn(float x, float y);
-    float distanceFromCenter(float x, float y);
-    String returnType();
-
-private:
-    float m_rad;
-};
-
-/**
-
-  Class for Stimulation Rectangle
-
-*/
-class StimRect : public StimArea
-{
-public:
-    StimRect();
-    StimRect(float x, float y, float w, float h, bool on);
-
-    float getW();
-    float getH();
-
-    void setW(float w);
-    void setH(float h);
-    void set(float x, float y, float w, float h, bool on);
-
-    bool isPositionIn(float x, float y) override;
-    float distanceFromCenter(float x, float y) override;
-    String returnType() override;
-
-private:
-    float m_w;
-    float m_h;
-};
-
-
-typedef enum
-{
-  uniform,
-  gauss,
-  ttl
-} stim_mode;
 
 /**
 
@@ -175,9 +92,12 @@ public:
     float getSimY() const;
     float getWidth(int s) const;
     float getHeight(int s) const;
+    /** Speed and heading of source s, from its kinematics channel. */
+    float getSpeed(int s) const;
+    float getHeading(int s) const;
 
     int getNSources() const;
-    TrackingSources& getTrackingSource(int s) const;
+    TrackingSources& getTrackingSource(int s);
 
     std::vector<StimCircle> getCircles();
     void addCircle(StimCircle c);
@@ -188,6 +108,16 @@ public:
     int getSelectedCircle() const;
     void setSelectedCircle(int ind);
 
+    // Polygons (e.g. maze arms) are loaded from the configuration file; they follow the circles in region order
+    std::vector<StimPolygon> getPolygons();
+    void addPolygon(StimPolygon p);
+    void deletePolygon(int ind);
+
+    int getNRegions() const;
+    bool getRegionOn(int ind) const;
+    int getMaskResolution() const;
+    void setMaskResolution(int cells);
+
     bool getSimulateTrajectory() const;
     int getOutputChan() const;
     int getSelectedSource() const;
@@ -197,6 +127,10 @@ public:
 //    bool getIsUniform() const;
     stim_mode getStimMode() const;
     int getTtlDuration() const;
+    int getInterPulse() const;
+    int getRepetitions() const;
+    prediction_model getPredictionModel() const;
+    float getPredictionLatency() const;
 
     void setSimulateTrajectory(bool sim);
     void setOutputChan(int chan);
@@ -206,7 +140,13 @@ public:
     void setStimSD(float stimSD);
 //    void setIsUniform(bool isUniform);
     void setStimMode(stim_mode mode);
+    /** Rate against normalized squared distance for the current mode, stimFreq and stimSD. */
+    const TrackingRateTable& getRateTable() const;
     void setTtlDuration(int dur);
+    void setInterPulse(int interval);
+    void setRepetitions(int pulses);
+    void setPredictionModel(prediction_model model);
+    void setPredictionLatency(float latency);
 
     void clearPositionDisplayedUpdated();
     bool positionDisplayedIsUpdated() const;
@@ -214,6 +154,7 @@ public:
     void setColorIsUpdated(bool up);
 
     int isPositionWithinCircles(float x, float y);
+    int isPositionWithinRegions(float x, float y);
 
     void save();
     void saveAs();
@@ -225,19 +166,24 @@ protected:
 private:
 
     CriticalSection lock;
-    Array<TrackingSources> sources;
+    TrackingSourceList sources;
 
     // OnOff
     bool m_isOn;
 
     // Time stim
     float m_timePassed;
-    int64 m_previousTime;
+    int64 m_previousTime; // global timestamps in samples, -1 before the first block
     int64 m_currentTime;
-    bool m_ttlTriggered;
 
-    std::default_random_engine generator;
+    TrackingStimDecision m_decision;
+    // rebuilt with updateRateTable() whenever m_stimMode, m_stimFreq or m_stimSD change
+    TrackingRateTable m_rateTable;
+    std::vector<float> m_pulseTimes; // train starts, seconds into the elapsed interval
 
+    // Latency compensation: the selected source's position extrapolated to the block being processed
+    TrackingPredictor m_predictor;
+    float m_predictionLatency; // ms between the frame exposure and the event's sample number
 
     // Time sim position
     float m_timePassed_sim;
@@ -261,6 +207,9 @@ private:
     bool m_colorUpdated;
 
     std::vector<StimCircle> m_circles;
+    std::vector<StimPolygon> m_polygons;
+    // rebuilt with updateRegionMask() whenever m_circles or m_polygons change
+    TrackingRegionMask m_regionMask;
     int m_selectedCircle;
 
     // Stimulation params
@@ -269,6 +218,14 @@ private:
 //    int m_isUniform;
     stim_mode m_stimMode;
     int m_pulseDuration;
+    int m_interPulse;  // ms between the end of a pulse and the start of the next in a train
+    int m_repetitions; // pulses per train
+
+    // every ON/OFF edge of the trains in flight, at its sample number
+    TrackingPulseScheduler m_pulses;
+    int m_pulseChan;
+    int64 m_previousBlockStart;
+    int64 m_droppedTrains; // trains the scheduler had no room for since startStimulation()
 
     // Selected stimulation chan
     int m_outputChan;
@@ -276,9 +233,13 @@ private:
 
     File currentConfigFile;
 
-    // Stimulate decision
-    bool stimulate();
-    void triggerEvent();
+    void sendPulseEdges(int64 blockStart, int nSamples);
+    void restartPulses(int64 blockStart);
+    void addPulseEdge(int64 blockStart, const TrackingPulseEdge& edge);
+    void updatePulseTrain();
+    void updateRateTable();
+    void updateRegionMask();
+    const StimArea& getRegion(int ind) const;
 
     bool saveParametersXml();
     bool loadParametersXml(File loadFile);
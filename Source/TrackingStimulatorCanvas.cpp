@@ -163,6 +163,7 @@ void TrackingStimulatorCanvas::resized()
 
     availableChans->setBounds(getWidth() - 0.2*getWidth(), 0.05*getHeight(), 0.18*getWidth(),0.04*getHeight());
     outputChans->setBounds(getWidth() - 0.2*getWidth(), 0.15*getHeight(), 0.18*getWidth(),0.04*getHeight());
+    predictionModels->setBounds(getWidth() - 0.14*getWidth(), 0.55*getHeight(), 0.07*getWidth(),0.04*getHeight());
 
     // Static Labels
     sourcesLabel->setBounds(getWidth() - 0.2*getWidth(), 0.0*getHeight(), 0.08*getWidth(), 0.04*getHeight());
@@ -178,6 +179,7 @@ void TrackingStimulatorCanvas::resized()
     fmaxLabel->setBounds(getWidth() - 0.2*getWidth(), 0.7*getHeight(), 0.1*getWidth(),0.04*getHeight());
     sdevLabel->setBounds(getWidth() - 0.2*getWidth(), 0.75*getHeight(), 0.1*getWidth(),0.04*getHeight());
     durationLabel->setBounds(getWidth() - 0.2*getWidth(), 0.8*getHeight(), 0.1*getWidth(),0.04*getHeight());
+    predictionLabel->setBounds(getWidth() - 0.2*getWidth(), 0.55*getHeight(), 0.06*getWidth(),0.04*getHeight());
 
     // Edit Labels
     cxEditLabel->setBounds(getWidth() - 0.14*getWidth(), 0.35*getHeight(), 0.06*getWidth(),0.04*getHeight());
@@ -186,7 +188,10 @@ void TrackingStimulatorCanvas::resized()
 
     fmaxEditLabel->setBounds(getWidth() - 0.1*getWidth(), 0.7*getHeight(), 0.08*getWidth(),0.04*getHeight());
     sdevEditLabel->setBounds(getWidth() - 0.1*getWidth(), 0.75*getHeight(), 0.08*getWidth(),0.04*getHeight());
-    durationEditLabel->setBounds(getWidth() - 0.1*getWidth(), 0.8*getHeight(), 0.08*getWidth(),0.04*getHeight());
+    durationEditLabel->setBounds(getWidth() - 0.1*getWidth(), 0.8*getHeight(), 0.025*getWidth(),0.04*getHeight());
+    pulsesEditLabel->setBounds(getWidth() - 0.0725*getWidth(), 0.8*getHeight(), 0.025*getWidth(),0.04*getHeight());
+    interPulseEditLabel->setBounds(getWidth() - 0.045*getWidth(), 0.8*getHeight(), 0.025*getWidth(),0.04*getHeight());
+    latencyEditLabel->setBounds(getWidth() - 0.065*getWidth(), 0.55*getHeight(), 0.045*getWidth(),0.04*getHeight());
     refresh();
 }
 
@@ -214,6 +219,10 @@ void TrackingStimulatorCanvas::comboBoxChanged(ComboBox* comboBox)
             outputChan = -1;
         processor->setOutputChan(outputChan);
     }
+    else if (comboBox == predictionModels)
+    {
+        processor->setPredictionModel((prediction_model) (comboBox->getSelectedId() - 1));
+    }
 }
 
 
@@ -528,6 +537,39 @@ void TrackingStimulatorCanvas::labelTextChanged(Label *label)
             label->setText("", dontSendNotification);
         }
     }
+    if (label == pulsesEditLabel)
+    {
+        Value val = label->getTextValue();
+        if (int(val.getValue())>=1)
+            processor->setRepetitions(int(val.getValue()));
+        else
+        {
+            CoreServices::sendStatusMessage("A train needs at least one pulse!");
+            label->setText(String(processor->getRepetitions()), dontSendNotification);
+        }
+    }
+    if (label == interPulseEditLabel)
+    {
+        Value val = label->getTextValue();
+        if (int(val.getValue())>=0)
+            processor->setInterPulse(int(val.getValue()));
+        else
+        {
+            CoreServices::sendStatusMessage("Selected values cannot be negative!");
+            label->setText(String(processor->getInterPulse()), dontSendNotification);
+        }
+    }
+    if (label == latencyEditLabel)
+    {
+        Value val = label->getTextValue();
+        if (float(val.getValue())>=0 && float(val.getValue())<=200)
+            processor->setPredictionLatency(float(val.getValue()));
+        else
+        {
+            CoreServices::sendStatusMessage("Latency must be between 0 and 200 ms!");
+            label->setText(String(processor->getPredictionLatency()), dontSendNotification);
+        }
+    }
 }
 
 
@@ -549,6 +591,11 @@ void TrackingStimulatorCanvas::update()
         availableChans->addItem(name, nextItem++);
     }
     availableChans->setSelectedId(processor->getSelectedSource()+2); //first is SELECT
+    predictionModels->setSelectedId(processor->getPredictionModel() + 1, dontSendNotification);
+    latencyEditLabel->setText(String(processor->getPredictionLatency()), dontSendNotification);
+    durationEditLabel->setText(String(processor->getTtlDuration()), dontSendNotification);
+    pulsesEditLabel->setText(String(processor->getRepetitions()), dontSendNotification);
+    interPulseEditLabel->setText(String(processor->getInterPulse()), dontSendNotification);
 }
 
 void TrackingStimulatorCanvas::refresh()
@@ -658,6 +705,18 @@ void TrackingStimulatorCanvas::initButtons()
     outputChans->setSelectedId(processor->getOutputChan() + 1, dontSendNotification);
     addAndMakeVisible(outputChans);
 
+    // Latency compensation of the selected source's position
+    predictionModels = new ComboBox("Prediction");
+
+    predictionModels->setEditableText(false);
+    predictionModels->setJustificationType(Justification::centredLeft);
+    predictionModels->addListener(this);
+    predictionModels->addItem("off", no_prediction + 1);
+    predictionModels->addItem("velocity", constant_velocity + 1);
+    predictionModels->addItem("acceleration", constant_acceleration + 1);
+    predictionModels->setSelectedId(processor->getPredictionModel() + 1, dontSendNotification);
+    addAndMakeVisible(predictionModels);
+
 
     // Create invisible circle toggle button
     for (int i = 0; i<MAX_CIRCLES; i++)
@@ -751,7 +810,7 @@ void TrackingStimulatorCanvas::initLabels()
     sdevLabel->setColour(Label::textColourId, labelColour);
     addAndMakeVisible(sdevLabel);
 
-    durationLabel = new Label("s_dur", "duration [ms]:");
+    durationLabel = new Label("s_dur", "train [ms,#,ms]:");
     durationLabel->setFont(Font(20));
     durationLabel->setColour(Label::textColourId, labelColour);
     addAndMakeVisible(durationLabel);
@@ -804,8 +863,43 @@ void TrackingStimulatorCanvas::initLabels()
     durationEditLabel->setColour(Label::backgroundColourId, labelBackgroundColour);
     durationEditLabel->setEditable(true);
     durationEditLabel->addListener(this);
+    durationEditLabel->setTooltip("Pulse duration [ms]");
     addAndMakeVisible(durationEditLabel);
 
+    // each trigger sends a train of pulses
+    pulsesEditLabel = new Label("pulses", String(processor->getRepetitions()));
+    pulsesEditLabel->setFont(Font(20));
+    pulsesEditLabel->setColour(Label::textColourId, labelTextColour);
+    pulsesEditLabel->setColour(Label::backgroundColourId, labelBackgroundColour);
+    pulsesEditLabel->setEditable(true);
+    pulsesEditLabel->addListener(this);
+    pulsesEditLabel->setTooltip("Pulses per train");
+    addAndMakeVisible(pulsesEditLabel);
+
+    interPulseEditLabel = new Label("interpulse", String(processor->getInterPulse()));
+    interPulseEditLabel->setFont(Font(20));
+    interPulseEditLabel->setColour(Label::textColourId, labelTextColour);
+    interPulseEditLabel->setColour(Label::backgroundColourId, labelBackgroundColour);
+    interPulseEditLabel->setEditable(true);
+    interPulseEditLabel->addListener(this);
+    interPulseEditLabel->setTooltip("Interval [ms] between the pulses of a train");
+    addAndMakeVisible(interPulseEditLabel);
+
+    predictionLabel = new Label("s_predict", "predict:");
+    predictionLabel->setFont(Font(20));
+    predictionLabel->setColour(Label::textColourId, labelColour);
+    addAndMakeVisible(predictionLabel);
+
+    // latency in ms between the frame and its event, the prediction extrapolates over it
+    latencyEditLabel = new Label("latency", String(processor->getPredictionLatency()));
+    latencyEditLabel->setFont(Font(20));
+    latencyEditLabel->setColour(Label::textColourId, labelTextColour);
+    latencyEditLabel->setColour(Label::backgroundColourId, labelBackgroundColour);
+    latencyEditLabel->setEditable(true);
+    latencyEditLabel->addListener(this);
+    latencyEditLabel->setTooltip("Latency [ms] from frame exposure to the tracking event");
+    addAndMakeVisible(latencyEditLabel);
+
     if (processor->getStimMode() == gauss)
     {
         sdevLabel->setVisible(true);
@@ -882,6 +976,28 @@ DisplayAxes::DisplayAxes(TrackingStimulator* TrackingStimulator, TrackingStimula
 
 DisplayAxes::~DisplayAxes(){}
 
+FillType DisplayAxes::getRateFill(Colour centre, Colour edge, float x_c, float y_c, float radx, float rady) const
+{
+    // shade by the stimulator's own rate table, so the field drawn is the one stimulated:
+    // centre at the highest rate, edge at none, radx and rady are the region's extent on screen
+    const TrackingRateTable& rates = processor->getRateTable();
+    const int stops = 16;
+    radx = jmax(radx, 1.0f);
+    rady = jmax(rady, 1.0f);
+
+    ColourGradient Cgrad = ColourGradient(centre, x_c, y_c, edge, x_c + radx, y_c, true);
+    Cgrad.clearColours();
+    for (int i = 0; i <= stops; i++)
+    {
+        float p = float(i) / stops;
+        float level = rates.getMaxRate() > 0 ? rates.getRate(p * p) / rates.getMaxRate() : 0;
+        Cgrad.addColour(p, edge.interpolatedWith(centre, level));
+    }
+
+    // the gradient is circular: stretch it along y to the region's extent there
+    return FillType(Cgrad, AffineTransform::scale(1.0f, rady / radx, x_c, y_c));
+}
+
 void DisplayAxes::paint(Graphics& g){
 
     xlims[0] = getBounds().getRight() - getWidth();
@@ -925,11 +1041,7 @@ void DisplayAxes::paint(Graphics& g){
                         if (processor->getStimMode() == uniform || processor->getStimMode() == ttl)
                             g.setColour(selectedCircleColour);
                         else
-                        {
-                            ColourGradient Cgrad = ColourGradient(Colours::darkmagenta, double(x_c), double(y_c),
-                                                                  Colours::yellow, double(x_c+radx), double(y_c+rady), true);
-                            g.setGradientFill(Cgrad);
-                        }
+                            g.setFillType(getRateFill(Colours::darkmagenta, Colours::yellow, x_c, y_c, radx, rady));
                         g.fillEllipse(x, y, 2*radx, 2*rady);
                     }
                 }
@@ -938,17 +1050,43 @@ void DisplayAxes::paint(Graphics& g){
                     if (processor->getStimMode() == uniform || processor->getStimMode() == ttl)
                         g.setColour(unselectedCircleColour);
                     else
-                    {
-                        ColourGradient Cgrad = ColourGradient(Colours::orange, double(x_c), double(y_c),
-                                                              Colours::lightgoldenrodyellow, double(x_c+radx), double(y_c+rady), true);
-                        g.setGradientFill(Cgrad);
-                    }
+                        g.setFillType(getRateFill(Colours::orange, Colours::lightgoldenrodyellow, x_c, y_c, radx, rady));
                     g.fillEllipse(x, y, 2*radx, 2*rady);
                 }
             }
         }
     }
 
+    // Draw polygons if they are ON
+    if (canvas->getUpdateCircle())
+    {
+        std::vector<StimPolygon> polygons = processor->getPolygons();
+        for (int i = 0; i < polygons.size(); i++)
+        {
+            if (!polygons[i].getOn() || polygons[i].getNumVertices() < 3)
+                continue;
+
+            Path outline;
+            outline.startNewSubPath(polygons[i].getVertexX(0) * getWidth() + xlims[0],
+                                    polygons[i].getVertexY(0) * getHeight() + ylims[0]);
+            for (int v = 1; v < polygons[i].getNumVertices(); v++)
+                outline.lineTo(polygons[i].getVertexX(v) * getWidth() + xlims[0],
+                               polygons[i].getVertexY(v) * getHeight() + ylims[0]);
+            outline.closeSubPath();
+
+            if (processor->getStimMode() == uniform || processor->getStimMode() == ttl)
+                g.setColour(unselectedCircleColour);
+            else
+            {
+                float x_c = polygons[i].getX() * getWidth() + xlims[0];
+                float y_c = polygons[i].getY() * getHeight() + ylims[0];
+                g.setFillType(getRateFill(Colours::orange, Colours::lightgoldenrodyellow, x_c, y_c,
+                                          polygons[i].getExtent() * getWidth(), polygons[i].getExtent() * getHeight()));
+            }
+            g.fillPath(outline);
+        }
+    }
+
     // Draw a point for the current position
     // if inside circle display in RED
     if (processor->getSimulateTrajectory())
@@ -963,9 +1101,9 @@ void DisplayAxes::paint(Graphics& g){
             x = int(pos_x * getWidth() + xlims[0]);
             y = int(pos_y * getHeight() + ylims[0]);
 
-            int circleIn = processor->isPositionWithinCircles(pos_x, pos_y);
+            int regionIn = processor->isPositionWithinRegions(pos_x, pos_y);
 
-            if (circleIn != -1 && processor->getCircles()[circleIn].getOn())
+            if (regionIn != -1 && processor->getRegionOn(regionIn))
                 g.setColour(inOfCirclesColour);
             else
                 g.setColour(outOfCirclesColour);
@@ -984,9 +1122,9 @@ void DisplayAxes::paint(Graphics& g){
             x = int(pos_x * getWidth() + xlims[0]);
             y = int(pos_y * getHeight() + ylims[0]);
 
-            int circleIn = processor->isPositionWithinCircles(pos_x, pos_y);
+            int regionIn = processor->isPositionWithinRegions(pos_x, pos_y);
 
-            if (circleIn != -1 && processor->getCircles()[circleIn].getOn())
+            if (regionIn != -1 && processor->getRegionOn(regionIn))
                 g.setColour(inOfCirclesColour);
             else
                 g.setColour(outOfCirclesColour);
@@ -1012,11 +1150,7 @@ void DisplayAxes::paint(Graphics& g){
         if (processor->getStimMode() == uniform || processor->getStimMode() == ttl)
             g.setColour(unselectedCircleColour);
         else
-        {
-            ColourGradient Cgrad = ColourGradient(Colours::darkmagenta, double(x_c), double(y_c),
-                                                  Colours::yellow, double(x_c+radx), double(y_c+rady), true);
-            g.setGradientFill(Cgrad);
-        }
+            g.setFillType(getRateFill(Colours::darkmagenta, Colours::yellow, x_c, y_c, radx, rady));
         g.fillEllipse(x, y, 2*radx, 2*rady);
 
     }
@@ -133,6 +133,7 @@ private:
 
     ScopedPointer<ComboBox> availableChans;
     ScopedPointer<ComboBox> outputChans;
+    ScopedPointer<ComboBox> predictionModels;
 
     ScopedPointer<UtilityButton> simTrajectoryButton;
 
@@ -149,6 +150,7 @@ private:
     ScopedPointer<Label> fmaxLabel;
     ScopedPointer<Label> sdevLabel;
     ScopedPointer<Label> durationLabel;
+    ScopedPointer<Label> predictionLabel;
 
     // Labels with editable test
     ScopedPointer<Label> cxEditLabel;
@@ -157,6 +159,9 @@ private:
     ScopedPointer<Label> fmaxEditLabel;
     ScopedPointer<Label> sdevEditLabel;
     ScopedPointer<Label> durationEditLabel;
+    ScopedPointer<Label> pulsesEditLabel;
+    ScopedPointer<Label> interPulseEditLabel;
+    ScopedPointer<Label> latencyEditLabel;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TrackingStimulatorCanvas);
 };
@@ -204,6 +209,8 @@ private:
     Colour outOfCirclesColour;
     Colour inOfCirclesColour;
 
+    FillType getRateFill(Colour centre, Colour edge, float x_c, float y_c, float radx, float rady) const;
+
     int64 click_time;
 
     bool m_firstPaint;
@@ -0,0 +1,149 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Tracking plugin for the Open Ephys GUI
+    Written by:
+
+    Alessio Buccino     alessiob@ifi.uio.no
+    Mikkel Lepperod
+    Svenn-Arne Dragly
+
+    Center for Integrated Neuroplasticity CINPLA
+    Department of Biosciences
+    University of Oslo
+    Norway
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "TrackingValidator.h"
+
+#include <cmath>
+#include <limits>
+
+TrackingValidator::TrackingValidator()
+    : m_maxSpeed (0.0)
+    , m_fillHorizon (0.0)
+    , m_boundsEnabled (false)
+    , m_xMin (0.0f)
+    , m_yMin (0.0f)
+    , m_xMax (1.0f)
+    , m_yMax (1.0f)
+    , m_zeroIsMissing (true)
+    , m_hasLast (false)
+    , m_lastTime (0.0)
+    , m_velocityX (0.0f)
+    , m_velocityY (0.0f)
+{
+}
+
+void TrackingValidator::setMaxSpeed (double maxSpeed)
+{
+    m_maxSpeed = maxSpeed;
+}
+
+void TrackingValidator::setFillHorizon (double fillHorizon)
+{
+    m_fillHorizon = fillHorizon;
+}
+
+void TrackingValidator::setBounds (bool enabled, float xMin, float yMin, float xMax, float yMax)
+{
+    m_boundsEnabled = enabled;
+    m_xMin = xMin;
+    m_yMin = yMin;
+    m_xMax = xMax;
+    m_yMax = yMax;
+}
+
+void TrackingValidator::setZeroIsMissing (bool zeroIsMissing)
+{
+    m_zeroIsMissing = zeroIsMissing;
+}
+
+void TrackingValidator::reset()
+{
+    m_hasLast = false;
+}
+
+bool TrackingValidator::hasPosition (const TrackingPosition& position, bool zeroIsMissing)
+{
+    if (std::isnan (position.x) || std::isnan (position.y))
+        return false;
+    return ! (zeroIsMissing && (position.x == 0.0f || position.y == 0.0f));
+}
+
+tracking_quality TrackingValidator::check (double time, const TrackingPosition& position) const
+{
+    if (! hasPosition (position, m_zeroIsMissing))
+        return quality_missing;
+
+    if (m_boundsEnabled && (position.x < m_xMin || position.x > m_xMax
+                            || position.y < m_yMin || position.y > m_yMax))
+        return quality_out_of_bounds;
+
+    if (m_maxSpeed > 0.0 && m_hasLast)
+    {
+        const double dt = time - m_lastTime;
+        // past the fill horizon the animal may really have moved: re-lock
+        if (dt >= 0.0 && (m_fillHorizon <= 0.0 || dt <= m_fillHorizon))
+        {
+            const double distance = std::hypot (position.x - m_last.x, position.y - m_last.y);
+            if (distance > m_maxSpeed * dt)
+                return quality_too_fast;
+        }
+    }
+    return quality_valid;
+}
+
+TrackingPosition TrackingValidator::validate (double time, const TrackingPosition& position, tracking_quality& quality)
+{
+    quality = check (time, position);
+
+    if (quality == quality_valid)
+    {
+        if (m_hasLast && time > m_lastTime)
+        {
+            const float dt = float (time - m_lastTime);
+            m_velocityX = (position.x - m_last.x) / dt;
+            m_velocityY = (position.y - m_last.y) / dt;
+        }
+        else
+        {
+            m_velocityX = 0.0f;
+            m_velocityY = 0.0f;
+        }
+        m_last = position;
+        m_lastTime = time;
+        m_hasLast = true;
+        return position;
+    }
+
+    TrackingPosition replacement = position;
+    const double dt = time - m_lastTime;
+    if (m_hasLast && dt >= 0.0 && dt <= m_fillHorizon)
+    {
+        replacement.x = m_last.x + m_velocityX * float (dt);
+        replacement.y = m_last.y + m_velocityY * float (dt);
+        quality = quality_filled;
+    }
+    else
+    {
+        replacement.x = std::numeric_limits<float>::quiet_NaN();
+        replacement.y = std::numeric_limits<float>::quiet_NaN();
+    }
+    return replacement;
+}
@@ -0,0 +1,100 @@
+/*
+    ------------------------------------------------------------------
+
+    This file is part of the Tracking plugin for the Open Ephys GUI
+    Written by:
+
+    Alessio Buccino     alessiob@ifi.uio.no
+    Mikkel Lepperod
+    Svenn-Arne Dragly
+
+    Center for Integrated Neuroplasticity CINPLA
+    Department of Biosciences
+    University of Oslo
+    Norway
+
+    ------------------------------------------------------------------
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACKINGVALIDATOR_H
+#define TRACKINGVALIDATOR_H
+
+#include "TrackingData.h"
+
+typedef enum
+{
+  quality_valid,
+  quality_filled,
+  quality_missing,
+  quality_out_of_bounds,
+  quality_too_fast
+} tracking_quality;
+
+/**
+    Per-source validation of tracked positions, run before any other stage.
+
+    Every position gets a quality flag. A position is rejected if it is missing
+    (not a number, or exactly zero when zeroIsMissing is set), outside the arena
+    bounds, or further from the last accepted position than maxSpeed allows for the
+    time in between. A rejected position is replaced by the last accepted one
+    extrapolated at its velocity, flagged quality_filled, for up to fillHorizon
+    seconds; after that it is replaced by NaN and keeps its own flag. Once the gap
+    outlasts the fill horizon the speed gate no longer applies, so tracking
+    re-locks onto an animal that really did move while it was hidden.
+
+    Filling can only look backwards here, as positions are validated as they
+    arrive, so gaps are bridged by extrapolation rather than interpolation.
+    A maxSpeed or fillHorizon of zero disables the speed gate or the filling.
+*/
+class TrackingValidator
+{
+public:
+    TrackingValidator();
+
+    void setMaxSpeed (double maxSpeed);
+    void setFillHorizon (double fillHorizon);
+    void setBounds (bool enabled, float xMin = 0.0f, float yMin = 0.0f, float xMax = 1.0f, float yMax = 1.0f);
+    void setZeroIsMissing (bool zeroIsMissing);
+
+    /** Forgets the last accepted position. */
+    void reset();
+
+    /** Validates the position measured at time (seconds) and returns what to pass downstream. */
+    TrackingPosition validate (double time, const TrackingPosition& position, tracking_quality& quality);
+
+    /** True if the position holds coordinates, without any of the other checks. */
+    static bool hasPosition (const TrackingPosition& position, bool zeroIsMissing = true);
+
+private:
+    tracking_quality check (double time, const TrackingPosition& position) const;
+
+    double m_maxSpeed;
+    double m_fillHorizon;
+    bool m_boundsEnabled;
+    float m_xMin;
+    float m_yMin;
+    float m_xMax;
+    float m_yMax;
+    bool m_zeroIsMissing;
+
+    bool m_hasLast;
+    double m_lastTime;
+    TrackingPosition m_last;
+    float m_velocityX;
+    float m_velocityY;
+};
+
+#endif // TRACKINGVALIDATOR_H
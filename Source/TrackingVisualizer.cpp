@@ -57,24 +57,19 @@ AudioProcessorEditor *TrackingVisualizer::createEditor()
 void TrackingVisualizer::updateSettings()
 {
     sources.clear();
-    TrackingSources s;
     int nEvents = getTotalEventChannels();
     for (int i = 0; i < nEvents; i++)
     {
         const EventChannel* event = getEventChannel(i);
         if (event->getName().compare("Tracking data") == 0)
         {
-            s.eventIndex = event->getSourceIndex();
-            s.sourceId =  event->getSourceNodeID();
-            s.name = "Tracking source " + String(event->getSourceIndex()+1);
-            s.color = "None";
-            s.x_pos = -1;
-            s.y_pos = -1;
-            s.width = -1;
-            s.height = -1;
-            sources.add (s);
+            sources.add (event->getSourceNodeID(), event->getSourceIndex());
             m_colorUpdated = true;
         }
+        // a source's kinematics channel follows its data channel
+        else if (event->getName().compare("Tracking kinematics") == 0 && sources.size() > 0
+                 && sources[sources.size() - 1].sourceId == event->getSourceNodeID())
+            sources.addAlias (event->getSourceNodeID(), event->getSourceIndex(), sources.size() - 1);
     }
 }
 
@@ -93,6 +88,15 @@ void TrackingVisualizer::process(AudioSampleBuffer &)
 
 void TrackingVisualizer::handleEvent (const EventChannel* eventInfo, const MidiMessage& event, int)
 {
+    if (eventInfo->getName().compare("Tracking kinematics") == 0)
+    {
+        BinaryEventPtr evtptr = BinaryEvent::deserializeFromMessage(event, eventInfo);
+        int sourceIndex = sources.indexOf (evtptr->getSourceID(), evtptr->getSourceIndex());
+        if (sourceIndex >= 0)
+            sources[sourceIndex].motion = *reinterpret_cast<const TrackingMotion *>(evtptr->getBinaryDataPointer());
+        return;
+    }
+
     if ((eventInfo->getName()).compare("Tracking data") != 0)
     {
         return;
@@ -104,43 +108,39 @@ void TrackingVisualizer::handleEvent (const EventChannel* eventInfo, const MidiM
     int evtId = evtptr->getSourceIndex();
     const auto *position = reinterpret_cast<const TrackingPosition *>(evtptr->getBinaryDataPointer());
 
-    int nSources = sources.size ();
+    int sourceIndex = sources.indexOf (nodeId, evtId);
+    if (sourceIndex < 0)
+        return;
 
-    for (int i = 0; i < nSources; i++)
+    TrackingSources& currentSource = sources[sourceIndex];
+    if (TrackingValidator::hasPosition(*position))
     {
-        TrackingSources& currentSource = sources.getReference (i);
-        if (currentSource.sourceId == nodeId && evtId == currentSource.eventIndex)
-        {
-            if(!(position->x != position->x || position->y != position->y) && position->x != 0 && position->y != 0)
-            {
-                currentSource.x_pos = position->x;
-                currentSource.y_pos = position->y;
-            }
-            if(!(position->width != position->width || position->height != position->height))
-            {
-                currentSource.width = position->width;
-                currentSource.height = position->height;
-            }
-
-            String sourceColor;
-            evtptr->getMetaDataValue(0)->getValue(sourceColor);
-
-            if (currentSource.color.compare(sourceColor) != 0)
-            {
-                currentSource.color = sourceColor;
-                m_colorUpdated = true;
-            }
-        }
+        currentSource.x_pos = position->x;
+        currentSource.y_pos = position->y;
+    }
+    if(!(position->width != position->width || position->height != position->height))
+    {
+        currentSource.width = position->width;
+        currentSource.height = position->height;
+    }
+
+    String sourceColor;
+    evtptr->getMetaDataValue(0)->getValue(sourceColor);
+
+    if (currentSource.color.compare(sourceColor) != 0)
+    {
+        currentSource.color = sourceColor;
+        m_colorUpdated = true;
     }
 
     m_positionIsUpdated = true;
 
 }
 
-TrackingSources& TrackingVisualizer::getTrackingSource(int s) const
+TrackingSources& TrackingVisualizer::getTrackingSource(int s)
 {
-    if (s < sources.size())
-        return sources.getReference (s);
+    jassert (s >= 0 && s < sources.size());
+    return sources[s];
 }
 
 
@@ -175,6 +175,22 @@ float TrackingVisualizer::getHeight(int s) const
         return -1;
 }
 
+float TrackingVisualizer::getSpeed(int s) const
+{
+    if (s >= 0 && s < sources.size())
+        return sources[s].motion.speed;
+    else
+        return -1;
+}
+
+float TrackingVisualizer::getHeading(int s) const
+{
+    if (s >= 0 && s < sources.size())
+        return sources[s].motion.heading;
+    else
+        return 0;
+}
+
 bool TrackingVisualizer::getIsRecording() const
 {
     return m_isRecording;
@@ -38,8 +38,6 @@
 
 #include <vector>
 
-#define MAX_SOURCES 10
-
 /**
 
     Visualizes tracking from "Tracking data" events
@@ -62,11 +60,14 @@ public:
     float getY(int s) const;
     float getWidth(int s) const;
     float getHeight(int s) const;
+    /** Speed and heading of source s, from its kinematics channel. */
+    float getSpeed(int s) const;
+    float getHeading(int s) const;
     bool getIsRecording() const;
     bool getClearTracking() const;
 
     int getNSources() const;
-    TrackingSources& getTrackingSource(int i) const;
+    TrackingSources& getTrackingSource(int i);
 
     void setClearTracking(bool clear);
 
@@ -77,7 +78,7 @@ public:
 
 private:
     
-    Array<TrackingSources> sources;
+    TrackingSourceList sources;
 
     bool m_positionIsUpdated;
     bool m_clearTracking;
@@ -95,6 +95,17 @@ TrackingVisualizerCanvas::~TrackingVisualizerCanvas()
 {
 }
 
+Colour TrackingVisualizerCanvas::getSourceColour(int index, const String& name) const
+{
+    auto it = color_palette.find(name);
+    if (it != color_palette.end())
+        return it->second;
+
+    // golden ratio hue steps keep neighbouring sources apart for any number of sources
+    float hue = fmodf(0.61803399f * index, 1.0f);
+    return Colour::fromHSV(hue, 0.75f, 1.0f, 1.0f);
+}
+
 void TrackingVisualizerCanvas::paint (Graphics& g)
 {
 
@@ -116,19 +127,18 @@ void TrackingVisualizerCanvas::paint (Graphics& g)
     g.fillRect(int(plot_bottom_left_x), int(plot_bottom_left_y),
                int(camWidth), int(camHeight));
 
-    for (int i = 0; i < processor->getNSources (); i++)
+    // update colors
+    if (processor->getColorIsUpdated())
     {
-        bool source_active = listbox->isRowSelected(i);
-        TrackingSources& source = processor->getTrackingSource(i);
-        Colour source_colour = color_palette[source.color];
-        g.setColour(source_colour);
+        update();
+        processor->setColorIsUpdated(false);
+    }
 
-        // update colors
-        if (processor->getColorIsUpdated())
-        {
-            update();
-            processor->setColorIsUpdated(false);
-        }
+    int nSources = jmin(processor->getNSources(), (int) m_positions.size(), (int) m_colours.size());
+    for (int i = 0; i < nSources; i++)
+    {
+        bool source_active = listbox->isRowSelected(i);
+        g.setColour(m_colours[i]);
 
         // Plot trajectory as lines
         if (m_positions[i].size () >= 2 && source_active)
@@ -184,11 +194,13 @@ void TrackingVisualizerCanvas::update()
     Array<String> listboxData;
 
     int nSources = processor->getNSources();
+    m_colours.resize(nSources);
     for (int i = 0; i < nSources; i++)
     {
         TrackingSources& source = processor->getTrackingSource(i);
         String name = source.name;
         listboxData.add (name);
+        m_colours[i] = getSourceColour(i, source.color);
     }
 
     listbox->setData(listboxData);
@@ -199,7 +211,11 @@ void TrackingVisualizerCanvas::update()
 void TrackingVisualizerCanvas::refresh()
 {
     if (processor->positionIsUpdated()) {
-        for (int i = 0; i<processor->getNSources(); i++)
+        int nSources = processor->getNSources();
+        if ((int) m_positions.size() != nSources)
+            m_positions.resize(nSources);
+
+        for (int i = 0; i < nSources; i++)
         {
             TrackingPosition currPos;
             currPos.x = processor->getX(i);
@@ -244,8 +260,8 @@ void TrackingVisualizerCanvas::setParameter(int, int, int, float)
 
 void TrackingVisualizerCanvas::clear()
 {
-    for (int i = 0; i<MAX_SOURCES; i++)
-        m_positions[i].clear();
+    for (auto& trajectory : m_positions)
+        trajectory.clear();
     repaint();
 }
 
@@ -93,24 +93,14 @@ private:
     ScopedPointer<UtilityButton> sameButton;
     ScopedPointer<Label> sourcesLabel;
 
-    /*std::map<String, Colour> color_palette = {
-        { "red", Colours::red },
-        { "green", Colours::green },
-        { "blue", Colours::blue },
-        { "cyan", Colours::cyan },
-        { "magenta", Colours::magenta },
-        { "yellow", Colours::yellow },
-        { "orange", Colours::orange },
-        { "pink", Colours::pink },
-        { "grey", Colours::grey },
-        { "violet", Colours::violet },
-        { "yellow", Colours::yellow },
-        { "white", Colours::white },
-        { "background", Colour(0, 18, 43) }
-    };*/
 	std::map<String, Colour> color_palette;
 
-    std::vector<TrackingPosition> m_positions[MAX_SOURCES];
+    /** Colour of source index: its named colour, or a generated hue for "auto" and unknown names. */
+    Colour getSourceColour(int index, const String& name) const;
+
+    // one trajectory and display colour per tracking source, resized with the source list
+    std::vector<std::vector<TrackingPosition>> m_positions;
+    std::vector<Colour> m_colours;
     void initButtonsAndLabels();
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TrackingVisualizerCanvas);
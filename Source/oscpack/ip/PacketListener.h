@@ -37,14 +37,33 @@
 #ifndef INCLUDED_OSCPACK_PACKETLISTENER_H
 #define INCLUDED_OSCPACK_PACKETLISTENER_H
 
+#include "IpEndpointName.h"
 
-class IpEndpointName;
+
+// one datagram of a batch delivered to PacketListener::ProcessPacketBatch()
+struct ReceivedDatagram{
+    const char *data;
+    int size;
+    IpEndpointName remoteEndpoint;
+    // kernel arrival time in nanoseconds since the epoch (CLOCK_REALTIME),
+    // or 0 if receive timestamps are not enabled on the socket
+    long long receiveTimeNs;
+};
 
 class PacketListener{
 public:
     virtual ~PacketListener() {}
     virtual void ProcessPacket( const char *data, int size, 
 			const IpEndpointName& remoteEndpoint ) = 0;
+
+    // Called when the multiplexer drained several datagrams from a socket
+    // with a single system call. The default implementation hands them to
+    // ProcessPacket() in arrival order.
+    virtual void ProcessPacketBatch( const ReceivedDatagram *datagrams, int count )
+    {
+        for( int i = 0; i < count; ++i )
+            ProcessPacket( datagrams[i].data, datagrams[i].size, datagrams[i].remoteEndpoint );
+    }
 };
 
 #endif /* INCLUDED_OSCPACK_PACKETLISTENER_H */
@@ -57,6 +57,11 @@
 #include <sys/socket.h>
 #include <sys/time.h>
 #include <netinet/in.h> // for sockaddr_in
+#include <sys/uio.h> // for iovec
+
+#if defined(__linux__)
+#include <sys/epoll.h>
+#endif
 
 #include <signal.h>
 #include <math.h>
@@ -161,6 +166,11 @@ public:
         setsockopt(socket_, SOL_SOCKET, SO_REUSEADDR, &reuseAddr, sizeof(reuseAddr));
     }
 
+    void SetEnableReceiveTimestamps( bool )
+    {
+        // kernel receive timestamps are not supported on Windows
+    }
+
     IpEndpointName LocalEndpointFor( const IpEndpointName& remoteEndpoint ) const
     {
         assert( isBound_ );
@@ -286,6 +296,11 @@ void UdpSocket::SetAllowReuse( bool allowReuse )
     impl_->SetAllowReuse( allowReuse );
 }
 
+void UdpSocket::SetEnableReceiveTimestamps( bool enableTimestamps )
+{
+    impl_->SetEnableReceiveTimestamps( enableTimestamps );
+}
+
 IpEndpointName UdpSocket::LocalEndpointFor( const IpEndpointName& remoteEndpoint ) const
 {
     return impl_->LocalEndpointFor( remoteEndpoint );
@@ -372,6 +387,7 @@ class SocketReceiveMultiplexer::Implementation{
 
 public:
     Implementation()
+        : break_( false )
     {
         breakEvent_ = CreateEvent( NULL, FALSE, FALSE, NULL );
     }
@@ -423,8 +439,6 @@ public:
 
     void Run()
     {
-        break_ = false;
-
         // prepare the window events which we use to wake up on incoming data
         // we use this instead of select() primarily to support the AsyncBreak()
         // mechanism.
@@ -513,6 +527,11 @@ public:
             unsigned long enableNonblocking = 0;
             ioctlsocket( i->second->impl_->Socket(), FIONBIO, &enableNonblocking );  // make the socket blocking again
         }
+
+        // a break requested while Run() was not executing is kept pending
+        // so that the next call returns immediately; clear it only once we
+        // have actually stopped.
+        break_ = false;
     }
 
     void Break()
@@ -679,6 +698,16 @@ public:
 #endif
     }
 
+    void SetEnableReceiveTimestamps( bool enableTimestamps )
+    {
+#if defined(__linux__)
+        int timestamps = (enableTimestamps) ? 1 : 0; // int on posix
+        setsockopt(socket_, SOL_SOCKET, SO_TIMESTAMPNS, &timestamps, sizeof(timestamps));
+#else
+        (void) enableTimestamps;
+#endif
+    }
+
     IpEndpointName LocalEndpointFor( const IpEndpointName& remoteEndpoint ) const
     {
         assert( isBound_ );
@@ -805,6 +834,11 @@ void UdpSocket::SetAllowReuse( bool allowReuse )
     impl_->SetAllowReuse( allowReuse );
 }
 
+void UdpSocket::SetEnableReceiveTimestamps( bool enableTimestamps )
+{
+    impl_->SetEnableReceiveTimestamps( enableTimestamps );
+}
+
 IpEndpointName UdpSocket::LocalEndpointFor( const IpEndpointName& remoteEndpoint ) const
 {
     return impl_->LocalEndpointFor( remoteEndpoint );
@@ -876,6 +910,91 @@ class SocketReceiveMultiplexer::Implementation{
     volatile bool break_;
     int breakPipe_[2]; // [0] is the reader descriptor and [1] the writer
 
+    enum { MAX_BUFFER_SIZE = 4098 };
+
+#if defined(__linux__)
+    // Datagrams are drained with recvmmsg() into these preallocated buffers
+    // and handed to the listener as one batch. A ready socket is read until
+    // it runs dry, but at most MAX_BATCHES_PER_WAKEUP times so that a
+    // flooded socket cannot starve the others.
+    enum { RECEIVE_BATCH_SIZE = 32, MAX_BATCHES_PER_WAKEUP = 8 };
+    enum { CONTROL_BUFFER_SIZE = CMSG_SPACE( sizeof(struct timespec) ) };
+
+    std::vector< char > batchData_;
+    std::vector< struct mmsghdr > batchHeaders_;
+    std::vector< struct iovec > batchIovecs_;
+    std::vector< struct sockaddr_in > batchAddresses_;
+    std::vector< char > batchControl_;
+    std::vector< ReceivedDatagram > batchDatagrams_;
+
+    void AllocateReceiveBatch()
+    {
+        if( !batchHeaders_.empty() )
+            return;
+
+        batchData_.resize( RECEIVE_BATCH_SIZE * MAX_BUFFER_SIZE );
+        batchHeaders_.resize( RECEIVE_BATCH_SIZE );
+        batchIovecs_.resize( RECEIVE_BATCH_SIZE );
+        batchAddresses_.resize( RECEIVE_BATCH_SIZE );
+        batchControl_.resize( RECEIVE_BATCH_SIZE * CONTROL_BUFFER_SIZE );
+        batchDatagrams_.resize( RECEIVE_BATCH_SIZE );
+
+        for( int i = 0; i < RECEIVE_BATCH_SIZE; ++i ){
+            batchIovecs_[i].iov_base = &batchData_[ i * MAX_BUFFER_SIZE ];
+            batchIovecs_[i].iov_len = MAX_BUFFER_SIZE;
+
+            std::memset( &batchHeaders_[i], 0, sizeof(batchHeaders_[i]) );
+            batchHeaders_[i].msg_hdr.msg_iov = &batchIovecs_[i];
+            batchHeaders_[i].msg_hdr.msg_iovlen = 1;
+            batchHeaders_[i].msg_hdr.msg_name = &batchAddresses_[i];
+            batchHeaders_[i].msg_hdr.msg_control = &batchControl_[ i * CONTROL_BUFFER_SIZE ];
+
+            batchDatagrams_[i].data = &batchData_[ i * MAX_BUFFER_SIZE ];
+        }
+    }
+
+    static long long ReceiveTimeNs( struct msghdr& header )
+    {
+        for( struct cmsghdr *cmsg = CMSG_FIRSTHDR( &header ); cmsg != 0; cmsg = CMSG_NXTHDR( &header, cmsg ) ){
+            if( cmsg->cmsg_level == SOL_SOCKET && cmsg->cmsg_type == SCM_TIMESTAMPNS ){
+                struct timespec ts;
+                std::memcpy( &ts, CMSG_DATA( cmsg ), sizeof(ts) );
+                return (long long)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+            }
+        }
+        return 0;
+    }
+
+    void ReceiveBatches( int socket, PacketListener *listener )
+    {
+        for( int batch = 0; batch < MAX_BATCHES_PER_WAKEUP; ++batch ){
+
+            for( int i = 0; i < RECEIVE_BATCH_SIZE; ++i ){
+                // the kernel overwrites these on every call
+                batchHeaders_[i].msg_hdr.msg_namelen = sizeof(struct sockaddr_in);
+                batchHeaders_[i].msg_hdr.msg_controllen = CONTROL_BUFFER_SIZE;
+                batchHeaders_[i].msg_hdr.msg_flags = 0;
+            }
+
+            int count = recvmmsg( socket, &batchHeaders_[0], RECEIVE_BATCH_SIZE, MSG_DONTWAIT, 0 );
+            if( count <= 0 )
+                return;
+
+            for( int i = 0; i < count; ++i ){
+                batchDatagrams_[i].size = (int)batchHeaders_[i].msg_len;
+                batchDatagrams_[i].remoteEndpoint.address = ntohl( batchAddresses_[i].sin_addr.s_addr );
+                batchDatagrams_[i].remoteEndpoint.port = ntohs( batchAddresses_[i].sin_port );
+                batchDatagrams_[i].receiveTimeNs = ReceiveTimeNs( batchHeaders_[i].msg_hdr );
+            }
+
+            listener->ProcessPacketBatch( &batchDatagrams_[0], count );
+
+            if( break_ || count < RECEIVE_BATCH_SIZE )
+                return;
+        }
+    }
+#endif
+
     double GetCurrentTimeMs() const
     {
         struct timeval t;
@@ -887,6 +1006,7 @@ class SocketReceiveMultiplexer::Implementation{
 
 public:
     Implementation()
+        : break_( false )
     {
         if( pipe(breakPipe_) != 0 )
             throw std::runtime_error( "creation of asynchronous break pipes failed\n" );
@@ -940,11 +1060,37 @@ public:
 
     void Run()
     {
-        break_ = false;
         char *data = 0;
+#if defined(__linux__)
+        int epollfd = -1;
+#endif
 
         try{
 
+#if defined(__linux__)
+            // register the inbound sockets with epoll. each event carries the
+            // index of its socket listener, offset by one so that zero can
+            // stand for the asynchronous break pipe.
+
+            epollfd = epoll_create1( EPOLL_CLOEXEC );
+            if( epollfd < 0 )
+                throw std::runtime_error("epoll_create1 failed\n");
+
+            struct epoll_event event;
+            std::memset( &event, 0, sizeof(event) );
+            event.events = EPOLLIN;
+            event.data.u64 = 0;
+            if( epoll_ctl( epollfd, EPOLL_CTL_ADD, breakPipe_[0], &event ) < 0 )
+                throw std::runtime_error("epoll_ctl failed\n");
+
+            for( std::size_t i = 0; i < socketListeners_.size(); ++i ){
+                event.data.u64 = i + 1;
+                if( epoll_ctl( epollfd, EPOLL_CTL_ADD, socketListeners_[i].second->impl_->Socket(), &event ) < 0 )
+                    throw std::runtime_error("epoll_ctl failed\n");
+            }
+
+            std::vector< struct epoll_event > readyEvents( socketListeners_.size() + 1 );
+#else
             // configure the master fd_set for select()
 
             fd_set masterfds, tempfds;
@@ -964,6 +1110,7 @@ public:
                     fdmax = i->second->impl_->Socket();
                 FD_SET( i->second->impl_->Socket(), &masterfds );
             }
+#endif
 
 
             // configure the timer queue
@@ -976,13 +1123,58 @@ public:
                 timerQueue_.push_back( std::make_pair( currentTimeMs + i->initialDelayMs, *i ) );
             std::sort( timerQueue_.begin(), timerQueue_.end(), CompareScheduledTimerCalls );
 
-            const int MAX_BUFFER_SIZE = 4098;
+#if defined(__linux__)
+            AllocateReceiveBatch();
+#else
             data = new char[ MAX_BUFFER_SIZE ];
             IpEndpointName remoteEndpoint;
 
             struct timeval timeout;
+#endif
 
             while( !break_ ){
+
+#if defined(__linux__)
+                int timeoutMs = -1;
+                if( !timerQueue_.empty() ){
+                    double remainingMs = timerQueue_.front().first - GetCurrentTimeMs();
+                    timeoutMs = ( remainingMs < 0 ) ? 0 : (int)ceil( remainingMs );
+                }
+
+                int readyCount = epoll_wait( epollfd, &readyEvents[0], (int)readyEvents.size(), timeoutMs );
+                if( readyCount < 0 ){
+                    if( break_ ){
+                        break;
+                    }else if( errno == EINTR ){
+                        continue;
+                    }else{
+                        throw std::runtime_error("epoll_wait failed\n");
+                    }
+                }
+
+                for( int i = 0; i < readyCount; ++i ){
+                    if( readyEvents[i].data.u64 == 0 ){
+                        // clear pending data from the asynchronous break pipe
+                        char c;
+                        read( breakPipe_[0], &c, 1 );
+                    }
+                }
+
+                if( break_ )
+                    break;
+
+                for( int i = 0; i < readyCount; ++i ){
+                    if( readyEvents[i].data.u64 == 0 )
+                        continue;
+
+                    std::pair< PacketListener*, UdpSocket* >& socketListener =
+                            socketListeners_[ readyEvents[i].data.u64 - 1 ];
+
+                    ReceiveBatches( socketListener.second->impl_->Socket(), socketListener.first );
+                    if( break_ )
+                        break;
+                }
+#else
                 tempfds = masterfds;
 
                 struct timeval *timeoutPtr = 0;
@@ -1034,6 +1226,7 @@ public:
                         }
                     }
                 }
+#endif
 
                 // execute any expired timers
                 currentTimeMs = GetCurrentTimeMs();
@@ -1053,11 +1246,24 @@ public:
             }
 
             delete [] data;
+#if defined(__linux__)
+            close( epollfd );
+#endif
         }catch(...){
             if( data )
                 delete [] data;
+#if defined(__linux__)
+            if( epollfd >= 0 )
+                close( epollfd );
+#endif
+            break_ = false;
             throw;
         }
+
+        // a break requested while Run() was not executing is kept pending
+        // so that the next call returns immediately; clear it only once we
+        // have actually stopped.
+        break_ = false;
     }
 
     void Break()
@@ -58,7 +58,9 @@ public:
     SocketReceiveMultiplexer();
     ~SocketReceiveMultiplexer();
 
-	// only call the attach/detach methods _before_ calling Run
+	// only call the attach/detach methods _before_ calling Run, or after it
+	// has returned. To change the attached sockets of a running multiplexer,
+	// break out of Run(), attach/detach, then call Run() again.
 
     // only one listener per socket, each socket at most once
     void AttachSocketListener( UdpSocket *socket, PacketListener *listener );
@@ -73,6 +75,7 @@ public:
 	void RunUntilSigInt();
     void Break();    // call this from a listener to exit once the listener returns
     void AsynchronousBreak(); // call this from another thread or signal handler to exit the Run() state
+                              // if Run() is not executing, the next call to Run() returns immediately
 };
 
 
@@ -102,6 +105,11 @@ public:
 	// operating systems.
 	void SetAllowReuse( bool allowReuse );
 
+	// Ask the kernel to timestamp every received datagram (SO_TIMESTAMPNS).
+	// The arrival time is reported in ReceivedDatagram::receiveTimeNs.
+	// Only supported on Linux; a no-op elsewhere.
+	void SetEnableReceiveTimestamps( bool enableTimestamps );
+
 
 	// The socket is created in an unbound, unconnected state
 	// such a socket can only be used to send to an arbitrary